@@ -0,0 +1,395 @@
+#include "bigint.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Run with --benchmark_out=results.json --benchmark_out_format=json to get
+// a file that can be compared between commits. Every operand comes from a
+// fixed seed, so two runs measure the same numbers.
+
+namespace {
+
+const size_t never = std::numeric_limits<size_t>::max();
+
+// A random string of the given number of decimal digits.
+std::string random_digits(size_t digits, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::string s(digits, '0');
+  s[0] = static_cast<char>('1' + rng() % 9);
+  for (size_t i = 1; i < digits; i++)
+    s[i] = static_cast<char>('0' + rng() % 10);
+  return s;
+}
+
+bigint random_bigint(size_t digits, uint64_t seed) {
+  return bigint(random_digits(digits, seed));
+}
+
+// Roughly the given limb count, 19.27 digits per limb.
+bigint random_limbs(size_t limbs, uint64_t seed) {
+  return random_bigint(limbs * 1927 / 100, seed);
+}
+
+size_t arg(const benchmark::State &state, int i) {
+  return static_cast<size_t>(state.range(i));
+}
+
+// Operand sizes in decimal digits, from a single limb to 10^7 digits.
+void digit_sizes(benchmark::internal::Benchmark *b) {
+  for (int64_t digits : {19, 100, 1000, 10000, 100000, 1000000, 10000000})
+    b->Arg(digits);
+  b->ArgName("digits")->Unit(benchmark::kMicrosecond);
+}
+
+// Restores the cutoffs changed by a crossover run when it goes out of scope.
+struct saved_thresholds {
+  size_t karatsuba = bigint::karatsuba_threshold;
+  size_t toom3 = bigint::toom3_threshold;
+  size_t ntt = bigint::ntt_threshold;
+  size_t bz = bigint::burnikel_ziegler_threshold;
+  size_t hgcd = bigint::hgcd_threshold;
+  ~saved_thresholds() {
+    bigint::karatsuba_threshold = karatsuba;
+    bigint::toom3_threshold = toom3;
+    bigint::ntt_threshold = ntt;
+    bigint::burnikel_ziegler_threshold = bz;
+    bigint::hgcd_threshold = hgcd;
+  }
+};
+
+void parse(benchmark::State &state) {
+  std::string s = random_digits(arg(state, 0), 1);
+  for (auto _ : state) {
+    bigint x(s);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+BENCHMARK(parse)->Apply(digit_sizes);
+
+void print(benchmark::State &state) {
+  bigint x = random_bigint(arg(state, 0), 2);
+  for (auto _ : state) {
+    std::string s = x.to_string();
+    benchmark::DoNotOptimize(s);
+  }
+}
+BENCHMARK(print)->Apply(digit_sizes);
+
+// The same numbers in hex, which goes through the bits, and base 36.
+void print_radix(benchmark::State &state) {
+  bigint x = random_bigint(arg(state, 0), 2);
+  unsigned base = static_cast<unsigned>(arg(state, 1));
+  for (auto _ : state) {
+    std::string s = x.to_string(base);
+    benchmark::DoNotOptimize(s);
+  }
+}
+void parse_radix(benchmark::State &state) {
+  unsigned base = static_cast<unsigned>(arg(state, 1));
+  std::string s = random_bigint(arg(state, 0), 1).to_string(base);
+  for (auto _ : state) {
+    bigint x = bigint::from_string(s, base);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+void radix_sizes(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"digits", "base"});
+  for (int64_t digits = 100; digits <= 1000000; digits *= 10)
+    for (int64_t base : {16, 36})
+      b->Args({digits, base});
+}
+BENCHMARK(print_radix)->Apply(radix_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(parse_radix)->Apply(radix_sizes)->Unit(benchmark::kMicrosecond);
+
+void add(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 3);
+  bigint b = random_bigint(arg(state, 0), 4);
+  for (auto _ : state) {
+    bigint c = a + b;
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(add)->Apply(digit_sizes);
+
+void sub(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 5);
+  bigint b = random_bigint(arg(state, 0), 6);
+  for (auto _ : state) {
+    bigint c = a - b;
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(sub)->Apply(digit_sizes);
+
+void mul(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 7);
+  bigint b = random_bigint(arg(state, 0), 8);
+  for (auto _ : state) {
+    bigint c = a * b;
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(mul)->Apply(digit_sizes);
+
+void square(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 9);
+  for (auto _ : state) {
+    bigint c = a.square();
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(square)->Apply(digit_sizes);
+
+// 2n digits by n digits, so that the quotient is as long as the divisor.
+void div(benchmark::State &state) {
+  bigint a = random_bigint(2 * arg(state, 0), 10);
+  bigint b = random_bigint(arg(state, 0), 11);
+  for (auto _ : state) {
+    bigint q = a / b;
+    benchmark::DoNotOptimize(q);
+  }
+}
+BENCHMARK(div)->Apply(digit_sizes);
+
+// Operands that only differ in the lowest limb, so every limb is compared.
+void compare(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 12);
+  bigint b = a + 1;
+  for (auto _ : state) {
+    int c = a.compare(b);
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(compare)->Apply(digit_sizes);
+
+// The gcd is quadratic below the half-gcd cutoff, so sizes stop at 10^5.
+void gcd_sizes(benchmark::internal::Benchmark *b) {
+  for (int64_t digits : {19, 100, 1000, 10000, 100000})
+    b->Arg(digits);
+  b->ArgName("digits")->Unit(benchmark::kMicrosecond);
+}
+
+void gcd(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 17);
+  bigint b = random_bigint(arg(state, 0), 18);
+  for (auto _ : state) {
+    bigint g = gcd(a, b);
+    benchmark::DoNotOptimize(g);
+  }
+}
+BENCHMARK(gcd)->Apply(gcd_sizes);
+
+void gcd_ext(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 19);
+  bigint b = random_bigint(arg(state, 0), 20);
+  for (auto _ : state) {
+    auto r = gcd_ext(a, b);
+    benchmark::DoNotOptimize(r);
+  }
+}
+BENCHMARK(gcd_ext)->Apply(gcd_sizes);
+
+void isqrt(benchmark::State &state) {
+  bigint a = random_bigint(arg(state, 0), 21);
+  for (auto _ : state) {
+    bigint r = isqrt(a);
+    benchmark::DoNotOptimize(r);
+  }
+}
+BENCHMARK(isqrt)->Apply(digit_sizes);
+
+// Multiplication crossovers. Each algorithm is forced at the top level, with
+// the default cutoffs below it, so that neighbouring algorithms cross where
+// the next tier starts paying off. The second argument picks the algorithm:
+// 0 schoolbook, 1 karatsuba, 2 toom3, 3 ntt.
+void mul_algorithm(benchmark::State &state) {
+  saved_thresholds saved;
+  size_t limbs = arg(state, 0);
+  size_t k = std::min(limbs, saved.karatsuba);
+  size_t t = std::min(limbs, saved.toom3);
+  static const char *const names[] = {"schoolbook", "karatsuba", "toom3",
+                                      "ntt"};
+  size_t algorithm = arg(state, 1);
+  bigint::karatsuba_threshold = algorithm >= 1 ? k : never;
+  bigint::toom3_threshold = algorithm >= 2 ? t : never;
+  bigint::ntt_threshold = algorithm >= 3 ? limbs : never;
+  state.SetLabel(names[algorithm]);
+  bigint a = random_limbs(limbs, 13);
+  bigint b = random_limbs(limbs, 14);
+  for (auto _ : state) {
+    bigint c = a * b;
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(mul_algorithm)
+    ->ArgNames({"limbs", "algorithm"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      // Schoolbook is skipped once it would take too long to be useful.
+      for (int64_t limbs = 8; limbs <= 65536; limbs *= 2)
+        for (int64_t algorithm = limbs <= 4096 ? 0 : 1; algorithm < 4;
+             algorithm++)
+          b->Args({limbs, algorithm});
+    })
+    ->Unit(benchmark::kMicrosecond);
+
+// Division crossover, 2n / n limbs, 0 knuth, 1 burnikel-ziegler.
+void div_algorithm(benchmark::State &state) {
+  saved_thresholds saved;
+  size_t limbs = arg(state, 0);
+  bool bz = arg(state, 1) != 0;
+  bigint::burnikel_ziegler_threshold = bz ? std::min(limbs, saved.bz) : never;
+  state.SetLabel(bz ? "burnikel_ziegler" : "knuth");
+  bigint a = random_limbs(2 * limbs, 15);
+  bigint b = random_limbs(limbs, 16);
+  for (auto _ : state) {
+    bigint q = a / b;
+    benchmark::DoNotOptimize(q);
+  }
+}
+BENCHMARK(div_algorithm)
+    ->ArgNames({"limbs", "algorithm"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      for (int64_t limbs = 16; limbs <= 16384; limbs *= 2)
+        for (int64_t bz = limbs <= 4096 ? 0 : 1; bz < 2; bz++)
+          b->Args({limbs, bz});
+    })
+    ->Unit(benchmark::kMicrosecond);
+
+// A multiply-add chain at a fixed width, wrapped to Bits bits, through
+// fixed_bigint<Bits> and through bigint with the same operands.
+template <class T, size_t Bits> void multiply_add(benchmark::State &state) {
+  bigint mask = (bigint(1) << (Bits - 1)) - 1;
+  T a(random_limbs(Bits / 64, 24) & mask);
+  T b(random_limbs(Bits / 64, 25) & mask);
+  T acc = 0;
+  for (auto _ : state) {
+    acc = a * acc + b;
+    if constexpr (std::is_same_v<T, bigint>)
+      acc &= mask;
+    benchmark::DoNotOptimize(acc);
+  }
+}
+BENCHMARK(multiply_add<fixed_bigint<256>, 256>);
+BENCHMARK(multiply_add<bigint, 256>);
+BENCHMARK(multiply_add<fixed_bigint<512>, 512>);
+BENCHMARK(multiply_add<bigint, 512>);
+
+// a * b + c over 2^16 independent elements, 0 one bigint at a time, 1
+// through bigint_batch.
+void elementwise_multiply_add(benchmark::State &state) {
+  size_t limbs = arg(state, 0);
+  bool batched = arg(state, 1) != 0;
+  state.SetLabel(batched ? "batch" : "scalar");
+  std::vector<bigint> a, b, c;
+  for (uint64_t i = 0; i < 65536; i++) {
+    a.push_back(random_limbs(limbs, 3 * i) >> 1);
+    b.push_back(random_limbs(limbs, 3 * i + 1) >> 1);
+    c.push_back(random_limbs(limbs, 3 * i + 2) >> 1);
+  }
+  bigint_batch ba(a), bb(b), bc(c);
+  std::vector<bigint> r(a.size());
+  for (auto _ : state) {
+    if (batched) {
+      bigint_batch br = batch_add(batch_mul(ba, bb), bc);
+      benchmark::DoNotOptimize(br.data());
+    } else {
+      for (size_t i = 0; i < a.size(); i++)
+        r[i] = a[i] * b[i] + c[i];
+      benchmark::DoNotOptimize(r.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * int64_t(a.size()));
+}
+BENCHMARK(elementwise_multiply_add)
+    ->ArgNames({"limbs", "batched"})
+    ->ArgsProduct({{1, 2, 4}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Gcd crossover, 0 lehmer, 1 half-gcd.
+void gcd_algorithm(benchmark::State &state) {
+  saved_thresholds saved;
+  size_t limbs = arg(state, 0);
+  bool hgcd = arg(state, 1) != 0;
+  bigint::hgcd_threshold = hgcd ? std::min(limbs / 2, saved.hgcd) : never;
+  state.SetLabel(hgcd ? "half_gcd" : "lehmer");
+  bigint a = random_limbs(limbs, 22);
+  bigint b = random_limbs(limbs, 23);
+  for (auto _ : state) {
+    bigint g = gcd(a, b);
+    benchmark::DoNotOptimize(g);
+  }
+}
+BENCHMARK(gcd_algorithm)
+    ->ArgNames({"limbs", "algorithm"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      for (int64_t limbs = 16; limbs <= 4096; limbs *= 2)
+        for (int64_t hgcd = 0; hgcd < 2; hgcd++)
+          b->Args({limbs, hgcd});
+    })
+    ->Unit(benchmark::kMicrosecond);
+
+std::vector<int64_t> one_to(size_t n) {
+  std::vector<int64_t> range(n);
+  for (size_t i = 0; i < n; i++)
+    range[i] = static_cast<int64_t>(i + 1);
+  return range;
+}
+
+void sizes_1e3_to_1e6(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(10)->Range(1000, 1000000)->ArgName("n");
+  b->Unit(benchmark::kMillisecond);
+}
+
+// The left fold 1 * 2 * ... * n that product() replaces. It is quadratic, so
+// it stops at 10^4.
+void product_fold(benchmark::State &state) {
+  std::vector<int64_t> range = one_to(arg(state, 0));
+  for (auto _ : state) {
+    bigint acc = 1;
+    for (int64_t x : range)
+      acc *= x;
+    benchmark::DoNotOptimize(acc);
+  }
+}
+BENCHMARK(product_fold)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10000)
+    ->ArgName("n")
+    ->Unit(benchmark::kMillisecond);
+
+void product(benchmark::State &state) {
+  std::vector<int64_t> range = one_to(arg(state, 0));
+  for (auto _ : state) {
+    bigint p = bigint::product(range.begin(), range.end());
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(product)->Apply(sizes_1e3_to_1e6);
+
+void factorial(benchmark::State &state) {
+  for (auto _ : state) {
+    bigint f = bigint::factorial(arg(state, 0));
+    benchmark::DoNotOptimize(f);
+  }
+}
+BENCHMARK(factorial)->Apply(sizes_1e3_to_1e6);
+
+// C(2n, n).
+void binomial(benchmark::State &state) {
+  uint64_t n = arg(state, 0);
+  for (auto _ : state) {
+    bigint c = bigint::binomial(2 * n, n);
+    benchmark::DoNotOptimize(c);
+  }
+}
+BENCHMARK(binomial)->Apply(sizes_1e3_to_1e6);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -1,10 +1,65 @@
 #include <algorithm>
-#include <cctype>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#endif
+#ifdef BIGINT_STATS
+#include <chrono>
+#endif
+
+// Counting hooks of the BIGINT_STATS build, which expand to nothing
+// otherwise. BIGINT_STATS_SCOPE counts a call of the given op_stats with its
+// operand limbs and adds the time until the end of the enclosing block.
+#ifdef BIGINT_STATS
+#define BIGINT_STATS_SCOPE(counter, limbs)                                     \
+  stats_scope bigint_stats_scope(counter, limbs)
+#define BIGINT_STATS_ADD(counter, n) ((counter) += (n))
+#else
+#define BIGINT_STATS_SCOPE(counter, limbs) ((void)0)
+#define BIGINT_STATS_ADD(counter, n) ((void)0)
+#endif
+
+#ifdef BIGINT_COMPILED_KERNELS
+// Built by bigint_kernels.cpp, which picks the fastest version for the CPU
+// when the program is loaded.
+extern "C" uint64_t bigint_addmul_1(uint64_t *r, const uint64_t *a, size_t n,
+                                    uint64_t b);
+extern "C" uint64_t bigint_mul_1(uint64_t *r, const uint64_t *a, size_t n,
+                                 uint64_t b);
+#endif
+
+// Asks for the constant trip count loops of fixed_bigint to be unrolled.
+#if defined(__clang__)
+#define BIGINT_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define BIGINT_UNROLL _Pragma("GCC unroll 16")
+#else
+#define BIGINT_UNROLL
+#endif
+
+class bigint_view;
+template <size_t Bits> class fixed_bigint;
 
 /**
  * @class bigint
@@ -15,57 +70,86 @@ public:
   /**
    * @brief Default constructor. Creates a bigint with zero value.
    */
-  bigint() : digits(1, 0), ne(false){};
+  bigint() : ne(false){};
 
   /**
-   * @brief Constructs a bigint from a signed 64-bit integer.
+   * @brief Enables the native integer overloads for integral types of at
+   * most 64 bits other than bool, so that they take precedence over
+   * converting the integer to a bigint without ever competing with the
+   * bigint overloads.
+   */
+  template <class T>
+  using if_integral =
+      std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                           sizeof(T) <= sizeof(uint64_t),
+                       int>;
+
+  /**
+   * @brief Constructs a bigint from a native integer of up to 64 bits,
+   * signed or unsigned.
    * @param num The integer value to be used.
+   *
+   * The magnitude is written straight into the inline storage, so this
+   * never allocates. INT64_MIN is negated in unsigned arithmetic.
    */
-  bigint(int64_t num) {
-    if (num == 0) {
-      digits = std::vector<uint8_t>(1, 0);
-      ne = false;
-      return;
-    } else if (num < 0) {
-      ne = true;
-      num = -num;
-    } else {
-      ne = false;
-    }
+  template <class T, if_integral<T> = 0>
+  bigint(T num) : limbs(scalar_abs(num), 0), ne(scalar_neg(num)) {}
 
-    while (num > 0) {
-      digits.push_back(static_cast<uint8_t>(num % 10));
-      num /= 10;
-    }
-  };
+  /**
+   * @brief Constructs a bigint from an unsigned 128-bit integer.
+   * @param num The integer value to be used.
+   */
+  __extension__ bigint(unsigned __int128 num)
+      : limbs(static_cast<limb>(num), static_cast<limb>(num >> 64)),
+        ne(false){};
 
   /**
    * @brief Constructs a bigint from a string.
    * @param num A string containing the number, starting with '-' if negative.
    * @throw std::invalid_argument if string is empty or contains invalid
    * characters.
+   *
+   * Accepts anything convertible to std::string_view, such as std::string
+   * and string literals, without copying it.
    */
-  bigint(const std::string &num) {
-    if (num.empty())
+  bigint(std::string_view num) : bigint(num.data(), num.size()){};
+
+  /**
+   * @brief Constructs a bigint from a character buffer.
+   * @param num Pointer to the characters, starting with '-' if negative.
+   * @param len The number of characters, not counting any terminator.
+   * @throw std::invalid_argument if the buffer is empty or contains invalid
+   * characters.
+   *
+   * Digits are validated and converted eight at a time. Inputs too long for
+   * the 19-digits-per-limb loop are split in halves recursively and joined
+   * by multiplying with powers of ten, so parsing costs about as much as a
+   * multiplication.
+   */
+  bigint(const char *num, size_t len) : ne(false) {
+    BIGINT_STATS_SCOPE(thread_stats.parse, len / chunk_digits + 1);
+    if (len == 0)
       throw std::invalid_argument("Empty string");
 
-    size_t i = 0;
-    ne = false;
     if (num[0] == '-') {
       ne = true;
-      i = 1;
+      num++;
+      len--;
     }
 
-    for (; i < num.size(); i++) {
-      if (!std::isdigit(num[i]))
-        throw std::invalid_argument("Invalid character");
-      digits.push_back(static_cast<uint8_t>(num[i] - '0'));
-    }
-
-    if (digits.empty())
+    if (len == 0)
       throw std::invalid_argument("String does not contain any digits");
+    if (!all_digits(num, len))
+      throw std::invalid_argument("Invalid character");
+
+    if (len <= decimal_basecase_digits) {
+      parse_basecase(num, len, 10);
+    } else {
+      bool sign = ne;
+      *this = from_radix(num, len, 10);
+      ne = sign;
+    }
 
-    std::reverse(digits.begin(), digits.end());
     normalize();
   };
 
@@ -74,19 +158,48 @@ public:
    * @param rhs The right-hand side bigint of the addition.
    * @return The sum of the two bigints.
    */
-  bigint operator+(const bigint &rhs) const {
+  bigint operator+(const bigint &rhs) const & {
+    BIGINT_STATS_SCOPE(thread_stats.add, limbs.size() + rhs.limbs.size());
     if (ne == rhs.ne)
       return add(rhs);
     return sub(rhs);
   };
+  /**
+   * @brief Addition operator, computing into the storage of an expiring
+   * operand.
+   * @param rhs The right-hand side bigint of the addition.
+   * @return The sum of the two bigints.
+   *
+   * The rvalue overloads below work like the compound assignments on the
+   * operand that is about to be destroyed and move it into the result, so
+   * chains such as (a + b) * c - d reuse their temporaries' limbs.
+   */
+  bigint operator+(const bigint &rhs) && {
+    *this += rhs;
+    return std::move(*this);
+  };
+  bigint operator+(bigint &&rhs) const & {
+    rhs += *this;
+    return std::move(rhs);
+  };
+  bigint operator+(bigint &&rhs) && {
+    *this += rhs;
+    return std::move(*this);
+  };
 
   /**
    * @brief Addition assignment operator.
    * @param rhs The right-hand side bigint of the addition.
-   * @return The sum of the two bigints.
+   * @return Reference to *this, holding the sum of the two bigints.
+   *
+   * Works in place, the storage only grows when the carry needs a new limb.
    */
-  bigint operator+=(const bigint &rhs) {
-    *this = *this + rhs;
+  bigint &operator+=(const bigint &rhs) {
+    BIGINT_STATS_SCOPE(thread_stats.add, limbs.size() + rhs.limbs.size());
+    if (ne == rhs.ne)
+      add_abs(rhs);
+    else
+      sub_abs(rhs);
     return *this;
   };
 
@@ -95,19 +208,45 @@ public:
    * @param rhs The right-hand side bigint of the subtraction.
    * @return The difference of the two bigints.
    */
-  bigint operator-(const bigint &rhs) const {
+  bigint operator-(const bigint &rhs) const & {
+    BIGINT_STATS_SCOPE(thread_stats.sub, limbs.size() + rhs.limbs.size());
     if (ne == rhs.ne)
       return sub(rhs);
     return add(rhs);
   };
+  /**
+   * @brief Subtraction operator, computing into the storage of an expiring
+   * operand.
+   * @param rhs The right-hand side bigint of the subtraction.
+   * @return The difference of the two bigints.
+   */
+  bigint operator-(const bigint &rhs) && {
+    *this -= rhs;
+    return std::move(*this);
+  };
+  bigint operator-(bigint &&rhs) const & {
+    rhs -= *this;
+    rhs.negate();
+    return std::move(rhs);
+  };
+  bigint operator-(bigint &&rhs) && {
+    *this -= rhs;
+    return std::move(*this);
+  };
 
   /**
    * @brief Subtraction assignment operator.
    * @param rhs The right-hand side bigint of the subtraction.
-   * @return The difference of the two bigints.
+   * @return Reference to *this, holding the difference of the two bigints.
+   *
+   * Works in place, the storage only grows when the carry needs a new limb.
    */
-  bigint operator-=(const bigint &rhs) {
-    *this = *this - rhs;
+  bigint &operator-=(const bigint &rhs) {
+    BIGINT_STATS_SCOPE(thread_stats.sub, limbs.size() + rhs.limbs.size());
+    if (ne == rhs.ne)
+      sub_abs(rhs);
+    else
+      add_abs(rhs);
     return *this;
   };
 
@@ -116,263 +255,5422 @@ public:
    * @param rhs The right-hand side bigint of the multiplication.
    * @return The product of the two bigints.
    */
-  bigint operator*(const bigint &rhs) const {
+  bigint operator*(const bigint &rhs) const & {
+    if (this == &rhs)
+      return square();
+    BIGINT_STATS_SCOPE(thread_stats.mul, limbs.size() + rhs.limbs.size());
+
     bigint result;
-    result.ne = (ne != rhs.ne);
-    result.digits.resize(digits.size() + rhs.digits.size(), 0);
+    if (limbs.empty() || rhs.limbs.empty())
+      return result;
 
-    for (size_t i = 0; i < digits.size(); i++) {
-      uint8_t c = 0;
-      for (size_t j = 0; j < rhs.digits.size() || c > 0; j++) {
-        uint64_t product =
-            result.digits[i + j] +
-            digits[i] * (j < rhs.digits.size() ? rhs.digits[j] : 0) + c;
-        result.digits[i + j] = static_cast<uint8_t>(product % 10);
-        c = static_cast<uint8_t>(product / 10);
-      }
+    const bigint &longer = limbs.size() < rhs.limbs.size() ? rhs : *this;
+    const bigint &shorter = limbs.size() < rhs.limbs.size() ? *this : rhs;
+    result.ne = (ne != rhs.ne);
+    size_t n = limbs.size() + rhs.limbs.size();
+    if (n <= 2 * limb_vector::inline_capacity) {
+      // Small products are formed on the stack, so that a result which fits
+      // in the inline storage never touches the heap.
+      limb tmp[2 * limb_vector::inline_capacity];
+      mul_basecase(tmp, longer.limbs.data(), longer.limbs.size(),
+                   shorter.limbs.data(), shorter.limbs.size());
+      while (n > 0 && tmp[n - 1] == 0)
+        n--;
+      result.limbs.assign(tmp, tmp + n);
+      return result;
     }
+    result.limbs.resize(n);
+    mul_limbs(result.limbs.data(), longer.limbs.data(), longer.limbs.size(),
+              shorter.limbs.data(), shorter.limbs.size());
 
     result.normalize();
     return result;
   };
 
   /**
-   * @brief Multiplication assignment operator.
-   * @param rhs The right-hand side bigint of the multiplication.
-   * @return The product of the two bigints.
+   * @brief Squares the bigint.
+   * @return *this * *this.
+   *
+   * Uses dedicated squaring kernels, which save about half of the limb
+   * products at every tier. x * x calls this too.
    */
-  bigint operator*=(const bigint &rhs) {
-    *this = *this * rhs;
-    return *this;
+  bigint square() const {
+    BIGINT_STATS_SCOPE(thread_stats.square, limbs.size());
+    bigint result;
+    size_t n = limbs.size();
+    if (n == 0)
+      return result;
+    if (2 * n <= 2 * limb_vector::inline_capacity) {
+      limb tmp[2 * limb_vector::inline_capacity];
+      sqr_basecase(tmp, limbs.data(), n);
+      size_t len = 2 * n;
+      while (len > 0 && tmp[len - 1] == 0)
+        len--;
+      result.limbs.assign(tmp, tmp + len);
+      return result;
+    }
+    result.limbs.resize(2 * n);
+    sqr_limbs(result.limbs.data(), limbs.data(), n);
+    result.normalize();
+    return result;
   };
 
   /**
-   * @brief Negation operator.
-   * @return The negation of the bigint.
+   * @brief Raises base to a power.
+   * @param base The base.
+   * @param exp The exponent.
+   * @return base^exp, with 0^0 = 1.
+   * @throw std::length_error if the size of the result overflows size_t.
+   *
+   * Left-to-right binary exponentiation on top of square(). Both working
+   * buffers are sized for the final result up front, so the loop does not
+   * reallocate.
    */
-  bigint operator-() const {
-    bigint result = *this;
-    result.ne = !ne;
-    result.normalize();
+  friend bigint pow(const bigint &base, uint64_t exp) {
+    bigint result(1);
+    if (exp == 0)
+      return result;
+    if (base.limbs.empty())
+      return bigint();
+
+    const limb_vector &b = base.limbs;
+    if (b.size() == 1 && b[0] == 1)
+      return base.ne && (exp & 1) ? -result : result;
+    // At least (bit_length - 1) * exp + 1 bits, so an estimate that does
+    // not fit in size_t means a result that does not fit in memory.
+    size_t bit_length = base.bit_length_abs();
+    if (exp > SIZE_MAX / bit_length)
+      throw std::length_error("bigint too large");
+    size_t bits = bit_length * exp;
+    limb_vector cur, tmp;
+    cur.reserve(bits / 64 + 3);
+    tmp.reserve(bits / 64 + 3);
+    cur = b;
+
+    for (int i = 62 - __builtin_clzll(exp); i >= 0; i--) {
+      size_t n = cur.size();
+      tmp.resize(2 * n);
+      sqr_limbs(tmp.data(), cur.data(), n);
+      trim(tmp);
+      std::swap(cur, tmp);
+      if ((exp >> i) & 1) {
+        n = cur.size();
+        tmp.resize(n + b.size());
+        mul_limbs(tmp.data(), cur.data(), n, b.data(), b.size());
+        trim(tmp);
+        std::swap(cur, tmp);
+      }
+    }
+
+    result.limbs = std::move(cur);
+    result.ne = base.ne && (exp & 1);
     return result;
   };
 
   /**
-   * @brief Equality operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if the two bigints are equal, false otherwise.
+   * @brief Modular exponentiation.
+   * @param base The base.
+   * @param exp The exponent, which must not be negative.
+   * @param mod The modulus.
+   * @return base^exp mod |mod|, in [0, |mod|).
+   * @throw std::domain_error if mod is zero or exp is negative.
+   *
+   * Odd moduli go through a montgomery_context and even ones through a
+   * barrett_context, so the exponentiation loop does not allocate.
    */
-  bool operator==(const bigint &rhs) const {
-    return ne == rhs.ne && digits == rhs.digits;
+  friend bigint pow_mod(const bigint &base, const bigint &exp,
+                        const bigint &mod);
+
+  /**
+   * @brief Product of a range.
+   * @param first The beginning of the range of values convertible to bigint.
+   * @param last The end of the range.
+   * @return The product of all values, one for an empty range.
+   *
+   * Neighbours are multiplied pairwise level by level, a balanced product
+   * tree, so that the large products are between operands of similar size
+   * and reach the fast multiplication tiers. The products of one level are
+   * spread over bigint::mul_threads threads when they are large enough.
+   */
+  template <class It> static bigint product(It first, It last) {
+    std::vector<bigint> v(first, last);
+    return product_tree(v);
+  }
+
+  /**
+   * @brief Sum of a range.
+   * @param first The beginning of the range of values convertible to bigint.
+   * @param last The end of the range.
+   * @return The sum of all values, zero for an empty range.
+   *
+   * Each value is added in place into an accumulator, so the cost is linear
+   * in the total size. With more than one bigint::mul_threads and at least
+   * bigint::parallel_threshold values, contiguous chunks are summed on
+   * separate threads and the partial sums added at the end.
+   */
+  template <class It> static bigint sum(It first, It last) {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    size_t chunks = count >= parallel_threshold ? mul_threads : 1;
+    chunks = std::max<size_t>(1, std::min(chunks, count));
+    std::vector<It> bounds;
+    for (size_t c = 0; c <= chunks; c++) {
+      bounds.push_back(first);
+      if (c < chunks)
+        std::advance(first, count / chunks + (c < count % chunks));
+    }
+    std::vector<bigint> partial(chunks);
+    parallel_for(chunks, count, [&](size_t c) {
+      for (It it = bounds[c]; it != bounds[c + 1]; ++it)
+        partial[c] += *it;
+    });
+    for (size_t c = 1; c < chunks; c++)
+      partial[0] += partial[c];
+    return std::move(partial[0]);
+  }
+
+  /**
+   * @brief Factorial.
+   * @param n The argument.
+   * @return n!.
+   *
+   * Uses the prime swing: n! = ((n/2)!)^2 * swing(n), where swing(n) is a
+   * product of prime powers read off from the digits of n in each prime
+   * base. The powers of two are left out and shifted in at the end, and the
+   * prime powers are multiplied with a product tree.
+   */
+  static bigint factorial(uint64_t n) {
+    std::vector<limb> primes = primes_up_to(n);
+    bigint result = odd_factorial(n, primes);
+    result.shl_abs(n - static_cast<uint64_t>(__builtin_popcountll(n)));
+    return result;
   };
 
   /**
-   * @brief Inequality operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if the two bigints are not equal, false otherwise.
+   * @brief Binomial coefficient.
+   * @param n The size of the set.
+   * @param k The size of the subsets.
+   * @return n choose k, zero if k > n.
+   *
+   * When k is not too small against n, the result is assembled from its
+   * prime factorization, the exponent of p being the number of borrows in
+   * subtracting k from n in base p (Kummer). Otherwise the product of the k
+   * top factors is divided by k!.
    */
-  bool operator!=(const bigint &rhs) const { return !(*this == rhs); };
+  static bigint binomial(uint64_t n, uint64_t k) {
+    if (k > n)
+      return bigint();
+    k = std::min(k, n - k);
+    std::vector<limb> factors;
+    if (k < n / 16) {
+      for (uint64_t i = n - k + 1; i <= n && i != 0; i++)
+        factors.push_back(i);
+      return product_of_limbs(factors) / factorial(k);
+    }
+    for (limb p : primes_up_to(n)) {
+      limb f = 1;
+      // p^e <= n, so the power fits in a limb.
+      for (uint64_t a = n, b = k, c = n - k, borrow = 0; a != 0;
+           a /= p, b /= p, c /= p) {
+        borrow = (b % p + c % p + borrow) > a % p;
+        if (borrow)
+          f *= p;
+      }
+      if (f != 1)
+        factors.push_back(f);
+    }
+    return product_of_limbs(factors);
+  };
 
   /**
-   * @brief Less than operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if this bigint is less than the right-hand side, false
-   * otherwise.
+   * @brief Integer square root.
+   * @param n The radicand, which must not be negative.
+   * @return The largest r with r * r <= n.
+   * @throw std::domain_error if n is negative.
+   *
+   * Newton's iteration with increasing precision: each step doubles the
+   * number of correct bits with one division of that size, so the whole
+   * root costs about as much as a few divisions at full size.
    */
-  bool operator<(const bigint &rhs) const {
-    // Sign
-    if (ne != rhs.ne)
-      return ne; // ne != po => true => <, po != ne => false => >
-    if (!ne)
-      return abs_less(rhs);
-    return rhs.abs_less(*this);
+  friend bigint isqrt(const bigint &n) {
+    if (n.ne)
+      throw std::domain_error("Square root of a negative number");
+    return isqrt_abs(n);
   };
 
   /**
-   * @brief Less than or equal operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if this bigint is less than or equal to the right-hand side,
-   * false otherwise.
+   * @brief Integer k-th root.
+   * @param n The radicand, which must not be negative for even k.
+   * @param k The degree of the root.
+   * @return The k-th root of n truncated toward zero, the r of largest
+   * magnitude with |r|^k <= |n| and the sign of n.
+   * @throw std::domain_error if k is zero, or k is even and n negative.
+   *
+   * The root of the leading bits, computed recursively, is refined by
+   * Newton's iteration, which then only needs a step or two at full size.
    */
-  bool operator<=(const bigint &rhs) const {
-    return *this < rhs || *this == rhs;
+  friend bigint iroot(const bigint &n, uint64_t k) {
+    if (k == 0)
+      throw std::domain_error("Zeroth root");
+    if (n.ne && k % 2 == 0)
+      throw std::domain_error("Even root of a negative number");
+    bigint result = n;
+    result.ne = false;
+    if (k == 2)
+      result = isqrt_abs(result);
+    else if (k > 2)
+      result = iroot_abs(result, k);
+    result.ne = n.ne && !result.limbs.empty();
+    return result;
   };
+
   /**
-   * @brief Greater than operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if this bigint is greater than the right-hand side, false
-   * otherwise.
+   * @brief Greatest common divisor.
+   * @param a The first argument.
+   * @param b The second argument.
+   * @return The non-negative gcd of a and b, zero if both are zero.
+   *
+   * Binary gcd in machine words, Lehmer's algorithm, and a recursive
+   * half-gcd from bigint::hgcd_threshold limbs on, which batches the
+   * quotients of Euclid's algorithm into matrices computed from the leading
+   * halves of the operands.
    */
-  bool operator>(const bigint &rhs) const { return !(*this <= rhs); };
+  friend bigint gcd(const bigint &a, const bigint &b);
+
   /**
-   * @brief Greater than or equal operator.
-   * @param rhs The right-hand side bigint of the comparison.
-   * @return True if this bigint is greater than or equal to the right-hand
-   * side, false otherwise.
+   * @brief Least common multiple.
+   * @param a The first argument.
+   * @param b The second argument.
+   * @return The non-negative lcm of a and b, zero if either is zero.
    */
-  bool operator>=(const bigint &rhs) const { return !(*this < rhs); };
+  friend bigint lcm(const bigint &a, const bigint &b);
 
   /**
-   * @brief Insertion operator.
-   * @param stream The stream to write to.
-   * @param num The bigint to write.
-   * @return The stream.
+   * @brief Extended greatest common divisor.
+   * @param a The first argument.
+   * @param b The second argument.
+   * @return g = gcd(a, b) and Bezout coefficients x and y with
+   * a * x + b * y == g, |x| <= |b| / g and |y| <= |a| / g.
+   *
+   * The coefficients are the cofactor matrix that the half-gcd of gcd()
+   * accumulates along the way.
    */
-  friend std::ostream &operator<<(std::ostream &stream, const bigint &num) {
-    if (num.ne)
-      stream << '-';
-    for (size_t i = num.digits.size(); i > 0; i--) {
-      stream << static_cast<char>(num.digits[i - 1] + '0');
-    }
-    return stream;
-  };
+  friend std::tuple<bigint, bigint, bigint> gcd_ext(const bigint &a,
+                                                   const bigint &b);
 
   /**
-   * @brief Prefix increment operator.
-   * @return The incremented bigint.
+   * @brief Modular inverse.
+   * @param a The value to invert.
+   * @param mod The modulus.
+   * @return The x in [0, |mod|) with a * x == 1 mod |mod|.
+   * @throw std::domain_error if mod is zero or a is not invertible.
    */
-  bigint &operator++() {
-    *this = *this + bigint(1);
-    return *this;
-  };
+  friend bigint inverse_mod(const bigint &a, const bigint &mod);
+
   /**
-   * @brief Postfix increment operator.
-   * @return The original bigint.
+   * @brief Reusable Montgomery arithmetic modulo a fixed odd modulus.
    */
-  bigint operator++(int) {
-    bigint tmp = *this;
-    *this = *this + bigint(1);
-    return tmp;
-  };
+  class montgomery_context;
   /**
-   * @brief Prefix decrement operator.
-   * @return The decremented bigint.
+   * @brief Reusable Barrett arithmetic modulo a fixed modulus.
    */
-  bigint &operator--() {
-    *this = *this - bigint(1);
-    return *this;
+  class barrett_context;
+
+  friend struct std::hash<bigint>;
+  friend class bigint_view;
+  template <size_t Bits> friend class fixed_bigint;
+  friend class bigint_batch;
+
+  /**
+   * @brief Multiplication operator for an expiring left-hand side.
+   * @param rhs The right-hand side bigint of the multiplication.
+   * @return The product of the two bigints.
+   *
+   * A single-limb rhs is multiplied in place, otherwise the product is
+   * formed as usual and the old limbs are released.
+   */
+  bigint operator*(const bigint &rhs) && {
+    *this *= rhs;
+    return std::move(*this);
   };
+
   /**
-   * @brief Postfix decrement operator.
-   * @return The original bigint.
+   * @brief Multiplication assignment operator.
+   * @param rhs The right-hand side bigint of the multiplication.
+   * @return Reference to *this, holding the product of the two bigints.
+   *
+   * A single-limb rhs is multiplied in place. Longer products cannot overlap
+   * their operands, so they are computed into a new buffer that is then moved
+   * into *this.
    */
-  bigint operator--(int) {
-    bigint tmp = *this;
-    *this = *this - bigint(1);
-    return tmp;
+  bigint &operator*=(const bigint &rhs) {
+    if (limbs.empty() || rhs.limbs.empty()) {
+      limbs.clear();
+      ne = false;
+    } else if (rhs.limbs.size() == 1) {
+      BIGINT_STATS_SCOPE(thread_stats.mul, limbs.size() + 1);
+      limb c = mul_1(limbs.data(), limbs.data(), limbs.size(), rhs.limbs[0]);
+      if (c != 0)
+        limbs.push_back(c);
+      ne = ne != rhs.ne;
+    } else {
+      *this = *this * rhs;
+    }
+    return *this;
   };
 
-private:
   /**
-   * @brief Internal storage of the digits.
+   * @brief Fused multiply-add, *this += a * b.
+   * @param a The first factor.
+   * @param b The second factor.
+   * @return Reference to *this.
    *
-   * The order is from least significant digit to most significant digit, which
-   * helps with the arithmetics.
+   * Equivalent to *this += a * b without materializing the product as a
+   * bigint. Below the Karatsuba cutoff, and when the signs agree, the
+   * product rows are accumulated straight into the limbs of *this. Larger
+   * products go through a scratch buffer of the thread's memory resource.
    */
-  std::vector<uint8_t> digits;
+  bigint &addmul(const bigint &a, const bigint &b) {
+    fused_mul(a, b, a.ne != b.ne);
+    return *this;
+  };
+
   /**
-   * @brief Sign indicator.
+   * @brief Fused multiply-subtract, *this -= a * b.
+   * @param a The first factor.
+   * @param b The second factor.
+   * @return Reference to *this.
    *
-   * If true, the number is negative.
+   * The counterpart of addmul, with the same cost.
    */
-  bool ne;
+  bigint &submul(const bigint &a, const bigint &b) {
+    fused_mul(a, b, a.ne == b.ne);
+    return *this;
+  };
 
   /**
-   * @brief Adds two bigints.
-   * @param rhs The right-hand side bigint to add.
-   * @return bigint representing *this + rhs, sign being the same as *this.
+   * @brief Division and remainder in one step.
+   * @param rhs The divisor.
+   * @return The quotient, truncated toward zero, and the remainder, which
+   * has the sign of *this, so that q * rhs + r == *this.
+   * @throw std::domain_error if rhs is zero.
+   *
+   * A single-limb divisor takes a linear pass, moderate sizes use Knuth's
+   * algorithm D and large ones the recursive Burnikel-Ziegler division,
+   * whose cost follows that of multiplication.
    */
-  bigint add(const bigint &rhs) const {
-    bigint result;
-    result.ne = ne;
-    size_t max_size = std::max(digits.size(), rhs.digits.size());
-    result.digits.resize(max_size, 0);
-
-    uint8_t c = 0;
-    for (size_t i = 0; i < max_size || c > 0; i++) {
-      uint8_t sum = c;
-      if (i == result.digits.size())
-        result.digits.push_back(0); // Last carry
-      if (i < digits.size())
-        sum += digits[i];
-      if (i < rhs.digits.size())
-        sum += rhs.digits[i];
-      c = sum / 10;
-      result.digits[i] = sum % 10;
-    }
+  std::pair<bigint, bigint> divmod(const bigint &rhs) const {
+    if (rhs.limbs.empty())
+      throw std::domain_error("Division by zero");
+    BIGINT_STATS_SCOPE(thread_stats.div, limbs.size() + rhs.limbs.size());
 
-    result.normalize();
+    std::pair<bigint, bigint> result;
+    divmod_abs(*this, rhs, result.first, result.second);
+    result.first.ne = ne != rhs.ne;
+    result.second.ne = ne;
+    result.first.normalize();
+    result.second.normalize();
     return result;
   };
 
   /**
-   * @brief Subtracts rhs from *this.
-   * @param rhs The right-hand side bigint to subtract.
-   * @return bigint representing *this - rhs.
-   *
-   * It finds the absolute different between the two bigints and determine the
-   * sign of the result based on the absolute values and signs.
+   * @brief Division operator.
+   * @param rhs The right-hand side bigint of the division.
+   * @return The quotient, truncated toward zero.
+   * @throw std::domain_error if rhs is zero.
    */
-  bigint sub(const bigint &rhs) const {
-    bigint result;
-    result.digits.clear(); // Remove the unused zero
-    bool is_abs_less = abs_less(rhs);
-    const bigint &larger = is_abs_less ? rhs : *this;
-    const bigint &smaller = is_abs_less ? *this : rhs;
+  bigint operator/(const bigint &rhs) const { return divmod(rhs).first; };
 
-    if (ne != rhs.ne) {
-      result.ne = ne;
-    } else {
-      result.ne = is_abs_less ? !ne : ne;
-    }
+  /**
+   * @brief Division assignment operator.
+   * @param rhs The right-hand side bigint of the division.
+   * @return Reference to *this, holding the quotient.
+   * @throw std::domain_error if rhs is zero.
+   */
+  bigint &operator/=(const bigint &rhs) {
+    *this = divmod(rhs).first;
+    return *this;
+  };
 
-    uint8_t b = 0;
-    for (size_t i = 0; i < larger.digits.size(); i++) {
-      int16_t tmp = larger.digits[i] - b -
-                    (i < smaller.digits.size() ? smaller.digits[i] : 0);
-      if (tmp < 0) {
-        b = 1;
-        tmp += 10;
-      } else {
-        b = 0;
-      }
-      result.digits.push_back(static_cast<uint8_t>(tmp));
-    }
+  /**
+   * @brief Modulo operator.
+   * @param rhs The right-hand side bigint of the division.
+   * @return The remainder, with the sign of *this.
+   * @throw std::domain_error if rhs is zero.
+   */
+  bigint operator%(const bigint &rhs) const { return divmod(rhs).second; };
 
-    result.normalize();
-    return result;
+  /**
+   * @brief Modulo assignment operator.
+   * @param rhs The right-hand side bigint of the division.
+   * @return Reference to *this, holding the remainder.
+   * @throw std::domain_error if rhs is zero.
+   */
+  bigint &operator%=(const bigint &rhs) {
+    *this = divmod(rhs).second;
+    return *this;
   };
 
   /**
-   * @brief Compares absolute values of *this and rhs.
-   * @param rhs The right-hand side bigint.
-   * @return true if |*this| < |rhs|, false otherwise.
+   * @brief Addition assignment with a native integer.
+   * @param rhs The integer to add.
+   * @return Reference to *this.
+   *
+   * The mixed operators below run the one-limb kernels directly on the
+   * magnitude of the integer, which never becomes a bigint.
    */
-  bool abs_less(const bigint &rhs) const {
-    // Length
-    if (digits.size() != rhs.digits.size())
-      return digits.size() < rhs.digits.size();
-    // MSD -> LSD
-    for (size_t i = digits.size(); i > 0; i--) {
-      if (digits[i - 1] != rhs.digits[i - 1]) {
-        return digits[i - 1] < rhs.digits[i - 1];
-      }
+  template <class T, if_integral<T> = 0> bigint &operator+=(T rhs) {
+    add_scalar(scalar_abs(rhs), scalar_neg(rhs));
+    return *this;
+  }
+  /**
+   * @brief Subtraction assignment with a native integer.
+   * @param rhs The integer to subtract.
+   * @return Reference to *this.
+   */
+  template <class T, if_integral<T> = 0> bigint &operator-=(T rhs) {
+    add_scalar(scalar_abs(rhs), !scalar_neg(rhs));
+    return *this;
+  }
+  /**
+   * @brief Multiplication assignment with a native integer.
+   * @param rhs The integer to multiply by.
+   * @return Reference to *this.
+   */
+  template <class T, if_integral<T> = 0> bigint &operator*=(T rhs) {
+    BIGINT_STATS_SCOPE(thread_stats.mul, limbs.size() + 1);
+    limb m = scalar_abs(rhs);
+    if (m == 0 || limbs.empty()) {
+      limbs.clear();
+      ne = false;
+      return *this;
     }
-    // Eq
-    return false;
+    limb c = mul_1(limbs.data(), limbs.data(), limbs.size(), m);
+    if (c != 0)
+      limbs.push_back(c);
+    ne = ne != scalar_neg(rhs);
+    return *this;
   }
-
   /**
-   * @brief Normalizes by removing leading zeros and fixing sign for
+   * @brief Division assignment with a native integer, truncating toward
    * zero.
+   * @param rhs The divisor.
+   * @return Reference to *this.
+   * @throw std::domain_error if rhs is zero.
    */
-  void normalize() {
-    while (digits.size() > 1 && digits.back() == 0) {
-      digits.pop_back();
-    }
+  template <class T, if_integral<T> = 0> bigint &operator/=(T rhs) {
+    limb m = scalar_abs(rhs);
+    if (m == 0)
+      throw std::domain_error("Division by zero");
+    BIGINT_STATS_SCOPE(thread_stats.div, limbs.size() + 1);
+    BIGINT_STATS_ADD(thread_stats.div_1.calls, 1);
+    BIGINT_STATS_ADD(thread_stats.div_1.limbs, limbs.size() + 1);
+    divmod_1(limbs.data(), limbs.data(), limbs.size(), m);
+    ne = ne != scalar_neg(rhs);
+    normalize();
+    return *this;
+  }
+  /**
+   * @brief Modulo assignment with a native integer.
+   * @param rhs The divisor.
+   * @return Reference to *this, holding the remainder with the sign of
+   * *this.
+   * @throw std::domain_error if rhs is zero.
+   */
+  template <class T, if_integral<T> = 0> bigint &operator%=(T rhs) {
+    limb m = scalar_abs(rhs);
+    if (m == 0)
+      throw std::domain_error("Division by zero");
+    BIGINT_STATS_SCOPE(thread_stats.div, limbs.size() + 1);
+    BIGINT_STATS_ADD(thread_stats.div_1.calls, 1);
+    BIGINT_STATS_ADD(thread_stats.div_1.limbs, limbs.size() + 1);
+    limb r = divmod_1(limbs.data(), limbs.data(), limbs.size(), m);
+    limbs.clear();
+    if (r != 0)
+      limbs.push_back(r);
+    normalize();
+    return *this;
+  }
 
-    if (digits.size() == 1 && digits[0] == 0) {
-      ne = false;
+  /**
+   * @brief Addition with a native integer.
+   */
+  template <class T, if_integral<T> = 0> bigint operator+(T rhs) const & {
+    bigint result = *this;
+    result += rhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0> bigint operator+(T rhs) && {
+    *this += rhs;
+    return std::move(*this);
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator+(T lhs, const bigint &rhs) {
+    return rhs + lhs;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator+(T lhs, bigint &&rhs) {
+    return std::move(rhs) + lhs;
+  }
+  /**
+   * @brief Subtraction with a native integer.
+   */
+  template <class T, if_integral<T> = 0> bigint operator-(T rhs) const & {
+    bigint result = *this;
+    result -= rhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0> bigint operator-(T rhs) && {
+    *this -= rhs;
+    return std::move(*this);
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator-(T lhs, const bigint &rhs) {
+    bigint result = -rhs;
+    result += lhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator-(T lhs, bigint &&rhs) {
+    rhs.negate();
+    return std::move(rhs) + lhs;
+  }
+  /**
+   * @brief Multiplication with a native integer.
+   */
+  template <class T, if_integral<T> = 0> bigint operator*(T rhs) const & {
+    bigint result = *this;
+    result *= rhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0> bigint operator*(T rhs) && {
+    *this *= rhs;
+    return std::move(*this);
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator*(T lhs, const bigint &rhs) {
+    return rhs * lhs;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator*(T lhs, bigint &&rhs) {
+    return std::move(rhs) * lhs;
+  }
+  /**
+   * @brief Division by a native integer, truncating toward zero.
+   * @throw std::domain_error if rhs is zero.
+   */
+  template <class T, if_integral<T> = 0> bigint operator/(T rhs) const & {
+    bigint result = *this;
+    result /= rhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0> bigint operator/(T rhs) && {
+    *this /= rhs;
+    return std::move(*this);
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator/(T lhs, const bigint &rhs) {
+    return from_scalar(lhs) / rhs;
+  }
+  /**
+   * @brief Remainder of the division by a native integer, with the sign of
+   * *this.
+   * @throw std::domain_error if rhs is zero.
+   */
+  template <class T, if_integral<T> = 0> bigint operator%(T rhs) const & {
+    bigint result = *this;
+    result %= rhs;
+    return result;
+  }
+  template <class T, if_integral<T> = 0> bigint operator%(T rhs) && {
+    *this %= rhs;
+    return std::move(*this);
+  }
+  template <class T, if_integral<T> = 0>
+  friend bigint operator%(T lhs, const bigint &rhs) {
+    return from_scalar(lhs) % rhs;
+  }
+
+  /**
+   * @brief Three-way comparison with a native integer.
+   * @return Negative, zero or positive as this bigint is less than, equal
+   * to or greater than rhs.
+   */
+  template <class T, if_integral<T> = 0> int compare(T rhs) const {
+    limb m = scalar_abs(rhs);
+    bool neg = scalar_neg(rhs);
+    if (ne != neg)
+      return ne ? -1 : 1;
+    int c = limbs.size() > 1    ? 1
+            : limbs.empty()     ? (m != 0 ? -1 : 0)
+            : limbs[0] != m     ? (limbs[0] < m ? -1 : 1)
+                                : 0;
+    return ne ? -c : c;
+  }
+  /**
+   * @brief Comparisons with a native integer, on either side.
+   */
+  template <class T, if_integral<T> = 0> bool operator==(T rhs) const {
+    return compare(rhs) == 0;
+  }
+  template <class T, if_integral<T> = 0> bool operator!=(T rhs) const {
+    return compare(rhs) != 0;
+  }
+  template <class T, if_integral<T> = 0> bool operator<(T rhs) const {
+    return compare(rhs) < 0;
+  }
+  template <class T, if_integral<T> = 0> bool operator<=(T rhs) const {
+    return compare(rhs) <= 0;
+  }
+  template <class T, if_integral<T> = 0> bool operator>(T rhs) const {
+    return compare(rhs) > 0;
+  }
+  template <class T, if_integral<T> = 0> bool operator>=(T rhs) const {
+    return compare(rhs) >= 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator==(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) == 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator!=(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) != 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator<(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) > 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator<=(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) >= 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator>(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) < 0;
+  }
+  template <class T, if_integral<T> = 0>
+  friend bool operator>=(T lhs, const bigint &rhs) {
+    return rhs.compare(lhs) <= 0;
+  }
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+  template <class T, if_integral<T> = 0>
+  std::strong_ordering operator<=>(T rhs) const {
+    return compare(rhs) <=> 0;
+  }
+#endif
+
+  /**
+   * @brief Negation operator.
+   * @return The negation of the bigint.
+   */
+  bigint operator-() const & {
+    bigint result = *this;
+    result.negate();
+    return result;
+  };
+  /**
+   * @brief Negation of an expiring bigint, in O(1).
+   * @return The negation of the bigint, which takes over its limbs.
+   */
+  bigint operator-() && {
+    negate();
+    return std::move(*this);
+  };
+
+  /**
+   * @brief Equality operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if the two bigints are equal, false otherwise.
+   */
+  bool operator==(const bigint &rhs) const {
+    return ne == rhs.ne && limbs == rhs.limbs;
+  };
+
+  /**
+   * @brief Inequality operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if the two bigints are not equal, false otherwise.
+   */
+  bool operator!=(const bigint &rhs) const { return !(*this == rhs); };
+
+  /**
+   * @brief Three-way comparison.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return Negative, zero or positive as this bigint is less than, equal
+   * to or greater than the right-hand side.
+   *
+   * Decided by the signs, then the limb counts, and otherwise by a single
+   * scan from the most significant limb down to the first difference.
+   */
+  int compare(const bigint &rhs) const {
+    if (ne != rhs.ne)
+      return ne ? -1 : 1;
+    int c = cmp_abs(rhs);
+    return ne ? -c : c;
+  };
+
+  /**
+   * @brief Less than operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if this bigint is less than the right-hand side, false
+   * otherwise.
+   */
+  bool operator<(const bigint &rhs) const { return compare(rhs) < 0; };
+  /**
+   * @brief Less than or equal operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if this bigint is less than or equal to the right-hand side,
+   * false otherwise.
+   */
+  bool operator<=(const bigint &rhs) const { return compare(rhs) <= 0; };
+  /**
+   * @brief Greater than operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if this bigint is greater than the right-hand side, false
+   * otherwise.
+   */
+  bool operator>(const bigint &rhs) const { return compare(rhs) > 0; };
+  /**
+   * @brief Greater than or equal operator.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return True if this bigint is greater than or equal to the right-hand
+   * side, false otherwise.
+   */
+  bool operator>=(const bigint &rhs) const { return compare(rhs) >= 0; };
+
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+  /**
+   * @brief Three-way comparison operator, where the language has one.
+   * @param rhs The right-hand side bigint of the comparison.
+   * @return The ordering of this bigint relative to the right-hand side.
+   */
+  std::strong_ordering operator<=>(const bigint &rhs) const {
+    return compare(rhs) <=> 0;
+  };
+#endif
+
+  /**
+   * @brief Left shift, multiplying by 2^bits.
+   * @param bits The number of bits to shift by.
+   * @return The shifted bigint.
+   */
+  bigint operator<<(size_t bits) const & {
+    bigint result;
+    size_t n = limbs.size();
+    if (n == 0)
+      return result;
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    result.limbs.resize(n + k + 1);
+    limb *p = result.limbs.data();
+    if (s != 0)
+      p[n + k] = lshift(p + k, limbs.data(), n, s);
+    else
+      std::copy(limbs.begin(), limbs.end(), p + k);
+    result.ne = ne;
+    result.normalize();
+    return result;
+  };
+  /**
+   * @brief Left shift assignment operator.
+   * @param bits The number of bits to shift by.
+   * @return Reference to *this, multiplied by 2^bits.
+   */
+  bigint &operator<<=(size_t bits) {
+    shl_abs(bits);
+    return *this;
+  };
+  /**
+   * @brief Left shift of an expiring bigint, in place.
+   * @param bits The number of bits to shift by.
+   * @return The shifted bigint.
+   */
+  bigint operator<<(size_t bits) && {
+    shl_abs(bits);
+    return std::move(*this);
+  };
+
+  /**
+   * @brief Arithmetic right shift, dividing by 2^bits rounded toward
+   * negative infinity as on two's complement.
+   * @param bits The number of bits to shift by.
+   * @return The shifted bigint, so that -1 >> bits stays -1.
+   */
+  bigint operator>>(size_t bits) const & {
+    bigint result;
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    size_t n = limbs.size();
+    if (k < n) {
+      result.limbs.resize(n - k);
+      limb *p = result.limbs.data();
+      if (s != 0)
+        rshift(p, limbs.data() + k, n - k, s);
+      else
+        std::copy(limbs.begin() + k, limbs.end(), p);
+    }
+    result.normalize();
+    if (ne && low_bits_nonzero(bits))
+      result.increment_abs();
+    result.ne = ne && !result.limbs.empty();
+    return result;
+  };
+  /**
+   * @brief Arithmetic right shift assignment operator.
+   * @param bits The number of bits to shift by.
+   * @return Reference to *this, divided by 2^bits rounded toward negative
+   * infinity.
+   */
+  bigint &operator>>=(size_t bits) {
+    bool neg = ne;
+    bool round = neg && low_bits_nonzero(bits);
+    shr_abs(bits);
+    if (round)
+      increment_abs();
+    ne = neg && !limbs.empty();
+    return *this;
+  };
+  /**
+   * @brief Arithmetic right shift of an expiring bigint, in place.
+   * @param bits The number of bits to shift by.
+   * @return The shifted bigint.
+   */
+  bigint operator>>(size_t bits) && {
+    *this >>= bits;
+    return std::move(*this);
+  };
+
+  /**
+   * @brief Bitwise and, on the infinite two's complement representation.
+   * @param rhs The right-hand side bigint.
+   * @return The bitwise and, negative iff both operands are.
+   */
+  bigint operator&(const bigint &rhs) const & {
+    bigint result = *this;
+    result &= rhs;
+    return result;
+  };
+  bigint operator&(const bigint &rhs) && {
+    *this &= rhs;
+    return std::move(*this);
+  };
+  bigint operator&(bigint &&rhs) const & {
+    rhs &= *this;
+    return std::move(rhs);
+  };
+  bigint operator&(bigint &&rhs) && {
+    *this &= rhs;
+    return std::move(*this);
+  };
+  /**
+   * @brief Bitwise and assignment operator.
+   * @param rhs The right-hand side bigint, which may be *this.
+   * @return Reference to *this.
+   */
+  bigint &operator&=(const bigint &rhs) {
+    bitwise(rhs, [](limb x, limb y) { return x & y; });
+    return *this;
+  };
+  /**
+   * @brief Bitwise or, on the infinite two's complement representation.
+   * @param rhs The right-hand side bigint.
+   * @return The bitwise or, negative iff either operand is.
+   */
+  bigint operator|(const bigint &rhs) const & {
+    bigint result = *this;
+    result |= rhs;
+    return result;
+  };
+  bigint operator|(const bigint &rhs) && {
+    *this |= rhs;
+    return std::move(*this);
+  };
+  bigint operator|(bigint &&rhs) const & {
+    rhs |= *this;
+    return std::move(rhs);
+  };
+  bigint operator|(bigint &&rhs) && {
+    *this |= rhs;
+    return std::move(*this);
+  };
+  /**
+   * @brief Bitwise or assignment operator.
+   * @param rhs The right-hand side bigint, which may be *this.
+   * @return Reference to *this.
+   */
+  bigint &operator|=(const bigint &rhs) {
+    bitwise(rhs, [](limb x, limb y) { return x | y; });
+    return *this;
+  };
+  /**
+   * @brief Bitwise exclusive or, on the infinite two's complement
+   * representation.
+   * @param rhs The right-hand side bigint.
+   * @return The bitwise exclusive or, negative iff exactly one operand is.
+   */
+  bigint operator^(const bigint &rhs) const & {
+    bigint result = *this;
+    result ^= rhs;
+    return result;
+  };
+  bigint operator^(const bigint &rhs) && {
+    *this ^= rhs;
+    return std::move(*this);
+  };
+  bigint operator^(bigint &&rhs) const & {
+    rhs ^= *this;
+    return std::move(rhs);
+  };
+  bigint operator^(bigint &&rhs) && {
+    *this ^= rhs;
+    return std::move(*this);
+  };
+  /**
+   * @brief Bitwise exclusive or assignment operator.
+   * @param rhs The right-hand side bigint, which may be *this.
+   * @return Reference to *this.
+   */
+  bigint &operator^=(const bigint &rhs) {
+    bitwise(rhs, [](limb x, limb y) { return x ^ y; });
+    return *this;
+  };
+  /**
+   * @brief Bitwise not.
+   * @return -*this - 1, the complement of every two's complement bit.
+   */
+  bigint operator~() const & {
+    bigint result = *this;
+    return ~std::move(result);
+  };
+  /**
+   * @brief Bitwise not of an expiring bigint, in place.
+   * @return -*this - 1.
+   */
+  bigint operator~() && {
+    if (ne) {
+      decrement_abs();
+      ne = false;
+    } else {
+      increment_abs();
+      ne = true;
+    }
+    return std::move(*this);
+  };
+
+  /**
+   * @brief Number of significant bits of the absolute value.
+   * @return The smallest n with |*this| < 2^n, 0 for zero.
+   */
+  size_t bit_length() const { return bit_length_abs(); };
+
+  /**
+   * @brief Number of set bits of the absolute value.
+   * @return The population count of |*this|.
+   */
+  size_t popcount() const {
+    size_t count = 0;
+    for (limb l : limbs)
+      count += static_cast<size_t>(__builtin_popcountll(l));
+    return count;
+  };
+
+  /**
+   * @brief Tests a bit of the infinite two's complement representation.
+   * @param i The bit index, 0 being the least significant bit.
+   * @return The bit, so that bits past the top are set for negatives.
+   */
+  bool test_bit(size_t i) const {
+    bool bit = i / 64 < limbs.size() && ((limbs[i / 64] >> (i % 64)) & 1);
+    if (!ne)
+      return bit;
+    // -x = ~(x - 1): x - 1 clears the lowest set bit of x and sets all the
+    // bits below it, leaving the ones above as they are.
+    size_t t = 0;
+    while (limbs[t / 64] == 0)
+      t += 64;
+    t += static_cast<size_t>(__builtin_ctzll(limbs[t / 64]));
+    return i < t ? false : i == t ? true : !bit;
+  };
+
+  /**
+   * @brief Whether the value is representable as an int64_t.
+   * @return True if INT64_MIN <= *this <= INT64_MAX.
+   */
+  bool fits_int64() const {
+    if (limbs.size() > 1)
+      return false;
+    limb m = limbs.empty() ? 0 : limbs[0];
+    return m <= (ne ? limb(1) << 63 : (limb(1) << 63) - 1);
+  };
+
+  /**
+   * @brief Converts to an int64_t.
+   * @return The value as an int64_t.
+   * @throw std::out_of_range if the value does not fit, see fits_int64().
+   */
+  int64_t to_int64() const {
+    if (!fits_int64())
+      throw std::out_of_range("Value does not fit in int64_t");
+    limb m = limbs.empty() ? 0 : limbs[0];
+    // Negate in unsigned arithmetic so INT64_MIN does not overflow.
+    return static_cast<int64_t>(ne ? 0 - m : m);
+  };
+
+  /**
+   * @brief Converts to a string in the given base.
+   * @param base The base, from 2 to 36, with the digits 0-9 and a-z.
+   * @return The digits, starting with '-' if negative.
+   * @throw std::invalid_argument if the base is out of range.
+   *
+   * See to_chars(), which this writes through into a string of the right
+   * size.
+   */
+  std::string to_string(unsigned base = 10) const {
+    check_base(base);
+    std::string out(max_digits(base) + 1, '0');
+    std::to_chars_result r = to_chars(&out[0], &out[0] + out.size(), base);
+    out.resize(static_cast<size_t>(r.ptr - out.data()));
+    return out;
+  };
+
+  /**
+   * @brief Writes the digits in the given base to a buffer, like
+   * std::to_chars, without allocating the output.
+   * @param first The beginning of the buffer.
+   * @param last The end of the buffer.
+   * @param base The base, from 2 to 36, with the digits 0-9 and a-z.
+   * @return The end of the digits and no error, or last and
+   * std::errc::value_too_large if they do not fit, leaving the contents
+   * of the buffer unspecified.
+   * @throw std::invalid_argument if the base is out of range.
+   *
+   * Power of two bases take the digits straight from the bits in linear
+   * time. Other bases split large numbers recursively by powers
+   * base^(d * 2^k), d being the digits of a chunk that fit in a limb, so the
+   * conversion costs about as much as a division rather than quadratic
+   * time.
+   */
+  std::to_chars_result to_chars(char *first, char *last,
+                                unsigned base = 10) const {
+    BIGINT_STATS_SCOPE(thread_stats.print, limbs.size());
+    check_base(base);
+    if (ne) {
+      if (first == last)
+        return {last, std::errc::value_too_large};
+      *first++ = '-';
+    }
+    char *end = (base & (base - 1)) == 0
+                    ? write_pow2(base, first, last)
+                    : write_radix(*this, base, first, last);
+    if (!end)
+      return {last, std::errc::value_too_large};
+    return {end, std::errc()};
+  };
+
+  /**
+   * @brief Parses a string in the given base.
+   * @param num The digits, 0-9 and a-z or A-Z, starting with '-' if
+   * negative.
+   * @param base The base, from 2 to 36.
+   * @return The value.
+   * @throw std::invalid_argument if the string is empty, contains
+   * characters that are not digits of the base, or the base is out of
+   * range.
+   *
+   * Not a constructor, as bigint("ff", 16) already means the first 16
+   * characters at "ff". See from_chars() for the algorithms.
+   */
+  static bigint from_string(std::string_view num, unsigned base) {
+    check_base(base);
+    if (num.empty())
+      throw std::invalid_argument("Empty string");
+    if (num == "-")
+      throw std::invalid_argument("String does not contain any digits");
+    bigint result;
+    const char *last = num.data() + num.size();
+    std::from_chars_result r = from_chars(num.data(), last, result, base);
+    if (r.ec != std::errc() || r.ptr != last)
+      throw std::invalid_argument("Invalid character");
+    return result;
+  };
+
+  /**
+   * @brief Parses the longest prefix of a buffer that is a number in the
+   * given base, like std::from_chars.
+   * @param first The beginning of the buffer.
+   * @param last The end of the buffer.
+   * @param value Set to the number if one was found, otherwise unchanged.
+   * @param base The base, from 2 to 36.
+   * @return The end of the number and no error, or first and
+   * std::errc::invalid_argument if the buffer does not start with one.
+   * @throw std::invalid_argument if the base is out of range.
+   *
+   * The number is an optional '-' followed by at least one digit, 0-9 and
+   * a-z or A-Z. Power of two bases pack the bits of the digits in linear
+   * time. Other bases convert chunks of digits that fit in a limb and join
+   * the halves of long inputs by multiplying with the powers that
+   * to_chars() divides by.
+   */
+  static std::from_chars_result from_chars(const char *first,
+                                           const char *last, bigint &value,
+                                           unsigned base = 10) {
+    check_base(base);
+    const char *p = first + (first != last && *first == '-');
+    const char *end = p;
+    while (end != last && digit_value(*end) < base)
+      end++;
+    size_t len = static_cast<size_t>(end - p);
+    if (len == 0)
+      return {first, std::errc::invalid_argument};
+
+    BIGINT_STATS_SCOPE(thread_stats.parse, len / chunk_digits + 1);
+    if ((base & (base - 1)) == 0)
+      value = from_pow2(p, len, base);
+    else
+      value = from_radix(p, len, base);
+    value.ne = p != first && !value.limbs.empty();
+    return {end, std::errc()};
+  };
+
+  /**
+   * @brief Computes the powers of the base that converting numbers of up to
+   * the given number of digits uses, so that later conversions find them
+   * ready.
+   * @param digits The number of digits.
+   * @param base The base, from 2 to 36.
+   * @throw std::invalid_argument if the base is out of range.
+   *
+   * The powers are cached for the whole process and shared by all threads.
+   * Conversions compute the ones that are missing themselves, so this only
+   * moves that cost to a convenient time, such as startup.
+   */
+  static void warm_powers(size_t digits, unsigned base = 10) {
+    check_base(base);
+    size_t chunk = chunk_of(base).digits, k = 0;
+    while (k + 1 < power_levels && chunk << (k + 1) < digits)
+      k++;
+    radix_power(base, k);
+  };
+
+  /**
+   * @brief Insertion operator.
+   * @param stream The stream to write to.
+   * @param num The bigint to write.
+   * @return The stream.
+   */
+  friend std::ostream &operator<<(std::ostream &stream, const bigint &num) {
+    // One write of the whole buffer rather than a character at a time.
+    return stream << num.to_string();
+  };
+
+  /**
+   * @brief Size of the binary record of this bigint.
+   * @return 8 * (limb count + 1) bytes, see to_bytes().
+   */
+  size_t byte_size() const { return (limbs.size() + 1) * sizeof(limb); };
+
+  /**
+   * @brief Serializes to the binary record format.
+   * @return The record: a 64-bit header holding (limb count << 1) | sign,
+   * followed by the limbs from the least significant one, all little
+   * endian.
+   *
+   * Records are a multiple of 8 bytes long, so records written back to back
+   * keep their limbs aligned, and bigint_view can use them in place.
+   */
+  std::vector<std::byte> to_bytes() const {
+    std::vector<std::byte> out(byte_size());
+    limb header = record_header();
+    std::memcpy(out.data(), &header, sizeof header);
+    std::memcpy(out.data() + sizeof header, limbs.data(),
+                limbs.size() * sizeof(limb));
+    if (!little_endian)
+      swap_limbs(out.data(), limbs.size() + 1);
+    return out;
+  };
+
+  /**
+   * @brief Deserializes a record written by to_bytes() or write().
+   * @param data The start of the record, with any alignment.
+   * @param size The bytes available at data, at least the record's size.
+   * @return The bigint of the record.
+   * @throw std::invalid_argument if the record is truncated or malformed.
+   */
+  static bigint from_bytes(const void *data, size_t size) {
+    bool neg;
+    size_t n = record_limbs(data, size, neg);
+    bigint result;
+    result.limbs.resize(n);
+    std::memcpy(result.limbs.data(),
+                static_cast<const unsigned char *>(data) + sizeof(limb),
+                n * sizeof(limb));
+    if (!little_endian)
+      swap_limbs(result.limbs.data(), n);
+    result.ne = neg;
+    check_record(result.limbs.data(), n, neg);
+    return result;
+  };
+
+  /**
+   * @brief Writes the binary record to a stream, see to_bytes().
+   * @param stream The stream to write to, opened in binary mode.
+   *
+   * On little endian hosts the limbs are written straight from the bigint,
+   * without an intermediate buffer.
+   */
+  void write(std::ostream &stream) const {
+    limb header = record_header();
+    if (!little_endian)
+      swap_limbs(&header, 1);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof header);
+    if (little_endian) {
+      stream.write(reinterpret_cast<const char *>(limbs.data()),
+                   static_cast<std::streamsize>(limbs.size() * sizeof(limb)));
+      return;
+    }
+    limb buf[256];
+    for (size_t i = 0; i < limbs.size(); i += 256) {
+      size_t len = std::min<size_t>(256, limbs.size() - i);
+      std::copy(limbs.begin() + i, limbs.begin() + i + len, buf);
+      swap_limbs(buf, len);
+      stream.write(reinterpret_cast<const char *>(buf),
+                   static_cast<std::streamsize>(len * sizeof(limb)));
+    }
+  };
+
+  /**
+   * @brief Reads one binary record from a stream, see to_bytes().
+   * @param stream The stream to read from, opened in binary mode.
+   * @return The bigint of the record.
+   * @throw std::invalid_argument if the stream ends inside the record or
+   * the record is malformed.
+   *
+   * The limbs are read straight into the bigint. Its storage grows with the
+   * data actually read, so a corrupt header cannot make it allocate more
+   * than the stream holds.
+   */
+  static bigint read(std::istream &stream) {
+    limb header;
+    if (!stream.read(reinterpret_cast<char *>(&header), sizeof header))
+      throw std::invalid_argument("Truncated bigint record");
+    if (!little_endian)
+      swap_limbs(&header, 1);
+    size_t n = static_cast<size_t>(header >> 1);
+    bigint result;
+    for (size_t done = 0; done < n;) {
+      size_t len = std::min<size_t>(n - done, std::max<size_t>(done, 4096));
+      result.limbs.resize(done + len);
+      if (!stream.read(
+              reinterpret_cast<char *>(result.limbs.data() + done),
+              static_cast<std::streamsize>(len * sizeof(limb))))
+        throw std::invalid_argument("Truncated bigint record");
+      if (!little_endian)
+        swap_limbs(result.limbs.data() + done, len);
+      done += len;
+    }
+    result.ne = (header & 1) != 0;
+    check_record(result.limbs.data(), n, result.ne);
+    return result;
+  };
+
+  /**
+   * @brief Copies the value a view points to.
+   * @param view The view.
+   */
+  explicit bigint(const bigint_view &view);
+
+  /**
+   * @brief Adds the value of a view in place, without copying it first.
+   * @param rhs The view to add.
+   * @return Reference to *this.
+   */
+  bigint &operator+=(const bigint_view &rhs);
+  /**
+   * @brief Subtracts the value of a view in place, without copying it
+   * first.
+   * @param rhs The view to subtract.
+   * @return Reference to *this.
+   */
+  bigint &operator-=(const bigint_view &rhs);
+
+  /**
+   * @brief Prefix increment operator.
+   * @return The incremented bigint.
+   *
+   * Only touches the low limbs that the carry reaches, so it is amortized
+   * O(1) and does not allocate unless the number grows by a limb.
+   */
+  bigint &operator++() {
+    if (!ne) {
+      increment_abs();
+    } else {
+      decrement_abs();
+      if (limbs.empty())
+        ne = false; // -1 -> 0
+    }
+    return *this;
+  };
+  /**
+   * @brief Postfix increment operator.
+   * @return The original bigint.
+   */
+  bigint operator++(int) {
+    bigint tmp = *this;
+    ++*this;
+    return tmp;
+  };
+  /**
+   * @brief Prefix decrement operator.
+   * @return The decremented bigint.
+   *
+   * Only touches the low limbs that the borrow reaches, so it is amortized
+   * O(1) and does not allocate unless the number grows by a limb.
+   */
+  bigint &operator--() {
+    if (ne || limbs.empty()) {
+      increment_abs();
+      ne = true; // 0 -> -1
+    } else {
+      decrement_abs();
+    }
+    return *this;
+  };
+  /**
+   * @brief Postfix decrement operator.
+   * @return The original bigint.
+   */
+  bigint operator--(int) {
+    bigint tmp = *this;
+    --*this;
+    return tmp;
+  };
+
+  /**
+   * @brief Limb count of the shorter operand from which operator* switches
+   * from schoolbook to Karatsuba multiplication.
+   */
+  static inline size_t karatsuba_threshold = 32;
+  /**
+   * @brief Limb count of the shorter operand from which operator* switches
+   * from Karatsuba to Toom-3 multiplication.
+   */
+  static inline size_t toom3_threshold = 192;
+  /**
+   * @brief Limb count of the shorter operand from which operator* switches
+   * from Toom-3 to number theoretic transform multiplication.
+   */
+  static inline size_t ntt_threshold = 12288;
+  /**
+   * @brief Limb count of the divisor, and of the quotient, from which
+   * division switches from Knuth's algorithm D to Burnikel-Ziegler.
+   */
+  static inline size_t burnikel_ziegler_threshold = 80;
+  /**
+   * @brief Limb count of the leading part of the operands from which gcd
+   * computes its batches of quotients with the recursive half-gcd instead
+   * of Lehmer's single-limb steps, so operands of about twice that use it.
+   */
+  static inline size_t hgcd_threshold = 96;
+
+  /**
+   * @brief Number of threads one multiplication may use, 1 to keep it on
+   * the calling thread.
+   *
+   * The sub-products of Karatsuba and Toom-3 and the three NTT primes are
+   * independent, so they are spread over the threads once large enough.
+   */
+  static inline size_t mul_threads = 1;
+  /**
+   * @brief Limb count of the sub-products from which a multiplication is
+   * split across threads, so that small sizes never pay for it.
+   */
+  static inline size_t parallel_threshold = 1024;
+  /**
+   * @brief Runs the given task on some thread, for example by posting it to
+   * a pool. When empty, std::thread is used.
+   *
+   * Tasks that have not started by the time their submitter is waiting for
+   * them are run by the submitter itself, so a saturated pool does not
+   * deadlock. Threads other than the caller's take their storage from their
+   * own memory resource.
+   */
+  static inline std::function<void(std::function<void()>)> mul_executor;
+
+  /**
+   * @brief The memory resource that heap limb storage and the scratch space
+   * of the algorithms are taken from on the calling thread.
+   * @return The bound resource, std::pmr::new_delete_resource() if none.
+   */
+  static std::pmr::memory_resource *get_memory_resource() {
+    return thread_resource ? thread_resource : std::pmr::new_delete_resource();
+  };
+
+  /**
+   * @brief Binds a memory resource to the calling thread.
+   * @param res The resource, or nullptr to go back to the default one.
+   * @return The previously bound resource, nullptr if none.
+   *
+   * Every block remembers the resource it came from and is returned there.
+   * bigints living in the resource must therefore be destroyed before it
+   * is, while copies made after unbinding it are independent of it.
+   */
+  static std::pmr::memory_resource *
+  set_memory_resource(std::pmr::memory_resource *res) {
+    return std::exchange(thread_resource, res);
+  };
+
+  /**
+   * @class scoped_memory_resource
+   * @brief Binds a memory resource to the calling thread for its lifetime,
+   * for example a std::pmr::monotonic_buffer_resource serving all the
+   * temporaries of a batch.
+   */
+  class scoped_memory_resource {
+  public:
+    explicit scoped_memory_resource(std::pmr::memory_resource *res)
+        : previous(set_memory_resource(res)){};
+    ~scoped_memory_resource() { set_memory_resource(previous); };
+    scoped_memory_resource(const scoped_memory_resource &) = delete;
+    scoped_memory_resource &operator=(const scoped_memory_resource &) = delete;
+
+  private:
+    std::pmr::memory_resource *previous;
+  };
+
+  /**
+   * @brief Calls, operand limbs and time of one operation or algorithm.
+   */
+  struct op_stats {
+    uint64_t calls;
+    uint64_t limbs;
+    uint64_t nanoseconds;
+  };
+
+  /**
+   * @brief Counters of the calling thread.
+   *
+   * Only gathered when compiled with BIGINT_STATS defined, all zero
+   * otherwise. Operations count every call, also the ones made by other
+   * operations, and their times include those of the nested calls. The
+   * algorithm tiers are counted at every level of the recursion, so a
+   * Karatsuba product also shows up in the tiers of its sub-products.
+   * Work done on the threads of a parallel multiplication is counted on
+   * those threads. Like op_stats, an aggregate without initializers that
+   * statistics() zeroes.
+   */
+  struct statistics {
+    op_stats add, sub, mul, square, div, parse, print;
+    op_stats mul_schoolbook, mul_karatsuba, mul_toom3, mul_ntt;
+    op_stats sqr_schoolbook, sqr_karatsuba, sqr_toom3, sqr_ntt;
+    op_stats div_1, div_knuth, div_burnikel_ziegler;
+    /**
+     * @brief Heap blocks taken for the limbs of bigints, and their bytes.
+     */
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    /**
+     * @brief Scratch blocks of the algorithms, and their bytes.
+     */
+    uint64_t scratch_allocations;
+    uint64_t scratch_bytes;
+  };
+
+#ifdef BIGINT_STATS
+  static constexpr bool stats_enabled = true;
+#else
+  static constexpr bool stats_enabled = false;
+#endif
+
+  /**
+   * @brief Snapshot of the counters of the calling thread.
+   * @return The counters since the thread started or last reset them.
+   */
+  static statistics stats() {
+#ifdef BIGINT_STATS
+    return thread_stats;
+#else
+    return statistics();
+#endif
+  };
+
+  /**
+   * @brief Resets the counters of the calling thread to zero.
+   */
+  static void reset_stats() {
+#ifdef BIGINT_STATS
+    thread_stats = statistics();
+#endif
+  };
+
+private:
+  /**
+   * @brief Resource bound by set_memory_resource, per thread.
+   */
+  static inline thread_local std::pmr::memory_resource *thread_resource =
+      nullptr;
+  /**
+   * @brief Threads available to the multiplication the calling thread is a
+   * part of, 0 outside of one.
+   */
+  static inline thread_local size_t thread_share = 0;
+
+#ifdef BIGINT_STATS
+  static inline thread_local statistics thread_stats{};
+
+  /**
+   * @brief Counts one call and its time into an op_stats.
+   */
+  class stats_scope {
+  public:
+    stats_scope(op_stats &s, size_t limbs)
+        : s(s), start(std::chrono::steady_clock::now()) {
+      s.calls++;
+      s.limbs += limbs;
+    }
+    ~stats_scope() {
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      s.nanoseconds += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count());
+    }
+    stats_scope(const stats_scope &) = delete;
+    stats_scope &operator=(const stats_scope &) = delete;
+
+  private:
+    op_stats &s;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   * @brief Counts the scratch blocks, forwarding them to the thread's
+   * memory resource.
+   *
+   * Each block keeps the resource it came from in a header, like the limb
+   * blocks, so that it is returned there from any thread.
+   */
+  class scratch_counter : public std::pmr::memory_resource {
+    void *do_allocate(size_t bytes, size_t align) override {
+      std::pmr::memory_resource *res = get_memory_resource();
+      size_t head = std::max(align, sizeof res);
+      char *block = static_cast<char *>(res->allocate(bytes + head, align));
+      std::memcpy(block + head - sizeof res, &res, sizeof res);
+      thread_stats.scratch_allocations++;
+      thread_stats.scratch_bytes += bytes;
+      return block + head;
+    }
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+      std::pmr::memory_resource *res;
+      size_t head = std::max(align, sizeof res);
+      char *block = static_cast<char *>(p) - head;
+      std::memcpy(&res, block + head - sizeof res, sizeof res);
+      res->deallocate(block, bytes + head, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other)
+        const noexcept override {
+      return this == &other;
+    }
+  };
+#endif
+
+  /**
+   * @brief The resource the scratch buffers of the algorithms come from.
+   */
+  static std::pmr::memory_resource *scratch_resource() {
+#ifdef BIGINT_STATS
+    static scratch_counter counter;
+    return &counter;
+#else
+    return get_memory_resource();
+#endif
+  }
+
+  /**
+   * @brief A single base 2^64 digit.
+   */
+  using limb = uint64_t;
+  /**
+   * @brief Double-width limb used for carries and products.
+   */
+  __extension__ typedef unsigned __int128 dlimb;
+  /**
+   * @brief Scratch limbs of the multiplication and division kernels, taken
+   * from the thread's memory resource like the limbs of a bigint.
+   */
+  using scratch_vector = std::pmr::vector<limb>;
+
+  /**
+   * @brief Largest power of ten that fits in a limb, and its exponent.
+   */
+  static constexpr limb chunk_base = 10000000000000000000ull;
+  static constexpr size_t chunk_digits = 19;
+  /**
+   * @brief Limb count below which decimal conversion peels off 19 digits
+   * at a time instead of recursing.
+   */
+  static constexpr size_t decimal_basecase_limbs = 32;
+  static constexpr size_t decimal_basecase_digits =
+      decimal_basecase_limbs * chunk_digits;
+
+  /**
+   * @brief The digits of a base that fit in a limb, and base^digits.
+   */
+  struct radix_chunk {
+    limb base;
+    size_t digits;
+  };
+
+  static constexpr radix_chunk chunk_of(unsigned base) {
+    radix_chunk c{base, 1};
+    while (c.base <= ~limb(0) / base) {
+      c.base *= base;
+      c.digits++;
+    }
+    return c;
+  }
+
+  static constexpr unsigned max_base = 36;
+  /**
+   * @brief Levels of power_cache, enough for any string length.
+   */
+  static constexpr size_t power_levels = 64;
+  /**
+   * @brief chunk_of(base).base^(2^i) at [base][i], shared by all threads.
+   *
+   * Entries are published once with a compare-and-swap and never change
+   * or go away, so readers need only an acquire load and no lock. They
+   * are deliberately not freed, as other threads may still be converting
+   * while the program exits.
+   */
+  static inline std::atomic<const bigint *> power_cache[max_base + 1]
+                                                       [power_levels];
+  static_assert(std::atomic<const bigint *>::is_always_lock_free);
+
+  /**
+   * @class limb_vector
+   * @brief Vector of limbs with inline storage for small magnitudes.
+   *
+   * Up to inline_capacity limbs live inside the object itself, so values
+   * that fit in 128 bits never allocate. Larger sizes spill to the heap and
+   * grow geometrically like std::vector, in blocks taken from the memory
+   * resource bound to the calling thread. Only the subset of the std::vector
+   * interface that bigint needs is provided, and new limbs are zeroed.
+   */
+  class limb_vector {
+  public:
+    static constexpr size_t inline_capacity = 2;
+    static_assert(sizeof(std::pmr::memory_resource *) <= sizeof(limb),
+                  "The block header must fit in a limb");
+
+    limb_vector() noexcept : n(0), cap(inline_capacity) {}
+    limb_vector(const limb_vector &other) : limb_vector() {
+      assign(other.begin(), other.end());
+    }
+    limb_vector(limb_vector &&other) noexcept : limb_vector() {
+      steal(other);
+    }
+    ~limb_vector() { release(); }
+
+    limb_vector &operator=(const limb_vector &other) {
+      if (this != &other)
+        assign(other.begin(), other.end());
+      return *this;
+    }
+    limb_vector &operator=(limb_vector &&other) noexcept {
+      if (this != &other) {
+        release();
+        steal(other);
+      }
+      return *this;
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    size_t capacity() const { return cap; }
+    limb *data() { return is_inline() ? buf : heap; }
+    const limb *data() const { return is_inline() ? buf : heap; }
+    limb *begin() { return data(); }
+    limb *end() { return data() + n; }
+    const limb *begin() const { return data(); }
+    const limb *end() const { return data() + n; }
+    limb &operator[](size_t i) { return data()[i]; }
+    limb operator[](size_t i) const { return data()[i]; }
+    limb &back() { return data()[n - 1]; }
+    limb back() const { return data()[n - 1]; }
+
+    void clear() { n = 0; }
+    void pop_back() { n--; }
+    void push_back(limb l) {
+      if (n == cap)
+        grow(n + 1);
+      data()[n++] = l;
+    }
+    void resize(size_t size) {
+      if (size > cap)
+        grow(size);
+      if (size > n)
+        std::fill(data() + n, data() + size, 0);
+      n = size;
+    }
+    void reserve(size_t size) {
+      if (size > cap)
+        grow(size);
+    }
+    void assign(const limb *first, const limb *last) {
+      size_t size = static_cast<size_t>(last - first);
+      if (size > cap) {
+        // Nothing to preserve, so skip the copy grow() would do.
+        n = 0;
+        grow(size);
+      }
+      std::copy(first, last, data());
+      n = size;
+    }
+
+    /**
+     * @brief Holds the magnitude lo + hi * 2^64 inline.
+     */
+    limb_vector(limb lo, limb hi) noexcept
+        : n(hi != 0 ? 2 : lo != 0), cap(inline_capacity), buf{lo, hi} {}
+
+    bool operator==(const limb_vector &other) const {
+      return n == other.n && std::equal(begin(), end(), other.begin());
+    }
+
+  private:
+    size_t n;
+    size_t cap;
+    union {
+      limb buf[inline_capacity];
+      limb *heap;
+    };
+
+    bool is_inline() const { return cap == inline_capacity; }
+
+    /**
+     * @brief Moves the storage to the heap with room for at least size limbs.
+     */
+    void grow(size_t size) {
+      size_t new_cap = std::max(size, 2 * cap);
+      if (new_cap >= SIZE_MAX / sizeof(limb))
+        throw std::length_error("bigint too large");
+      size_t bytes = (new_cap + 1) * sizeof(limb);
+      BIGINT_STATS_ADD(thread_stats.allocations, 1);
+      BIGINT_STATS_ADD(thread_stats.allocated_bytes, bytes);
+      std::pmr::memory_resource *res = thread_resource;
+      void *block =
+          res ? res->allocate(bytes, alignof(limb)) : ::operator new(bytes);
+      limb *p = static_cast<limb *>(block) + 1;
+      // The limb before the data remembers where the block came from, null
+      // for operator new, so that it goes back there even if another
+      // resource is bound by then.
+      std::memcpy(p - 1, &res, sizeof res);
+      std::copy(begin(), end(), p);
+      release();
+      heap = p;
+      cap = new_cap;
+    }
+
+    void release() {
+      if (!is_inline()) {
+        std::pmr::memory_resource *res;
+        std::memcpy(&res, heap - 1, sizeof res);
+        if (res)
+          res->deallocate(heap - 1, (cap + 1) * sizeof(limb), alignof(limb));
+        else
+          ::operator delete(heap - 1);
+      }
+      cap = inline_capacity;
+    }
+
+    /**
+     * @brief Takes over the contents of other, which must not own a heap
+     * buffer of this one, and leaves other empty.
+     */
+    void steal(limb_vector &other) {
+      if (other.is_inline()) {
+        std::copy(other.buf, other.buf + other.n, buf);
+      } else {
+        heap = other.heap;
+        cap = other.cap;
+        other.cap = inline_capacity;
+      }
+      n = other.n;
+      other.n = 0;
+    }
+  };
+
+  /**
+   * @brief Internal storage of the magnitude, in base 2^64.
+   *
+   * The order is from least significant limb to most significant limb, which
+   * helps with the arithmetics. A normalized value has no leading zero limbs,
+   * so zero is represented by an empty vector.
+   */
+  limb_vector limbs;
+  /**
+   * @brief Sign indicator.
+   *
+   * If true, the number is negative.
+   */
+  bool ne;
+
+  /**
+   * @brief Adds two bigints.
+   * @param rhs The right-hand side bigint to add.
+   * @return bigint representing *this + rhs, sign being the same as *this.
+   */
+  bigint add(const bigint &rhs) const {
+    bigint result;
+    result.ne = ne;
+    const bigint &longer = limbs.size() < rhs.limbs.size() ? rhs : *this;
+    const bigint &shorter = limbs.size() < rhs.limbs.size() ? *this : rhs;
+    size_t n = longer.limbs.size();
+    size_t m = shorter.limbs.size();
+    // Room for the last carry, unless the sum may still fit inline.
+    if (n > limb_vector::inline_capacity)
+      result.limbs.reserve(n + 1);
+    result.limbs.resize(n);
+
+    limb c = add_n(result.limbs.data(), longer.limbs.data(),
+                   shorter.limbs.data(), m);
+    c = add_1(result.limbs.data() + m, longer.limbs.data() + m, n - m, c);
+    // Only grow for the last carry, so that small sums stay inline.
+    if (c != 0)
+      result.limbs.push_back(c);
+
+    return result;
+  };
+
+  /**
+   * @brief Subtracts rhs from *this.
+   * @param rhs The right-hand side bigint to subtract.
+   * @return bigint representing |*this| - |rhs|, with the sign of *this.
+   *
+   * It finds the absolute different between the two bigints and determine the
+   * sign of the result based on the absolute values and signs.
+   */
+  bigint sub(const bigint &rhs) const {
+    bigint result;
+    bool is_abs_less = abs_less(rhs);
+    const bigint &larger = is_abs_less ? rhs : *this;
+    const bigint &smaller = is_abs_less ? *this : rhs;
+
+    // Whether called for a - b with equal signs or a + b with opposite signs,
+    // the result is sign(a) * (|a| - |b|).
+    result.ne = is_abs_less ? !ne : ne;
+
+    size_t n = larger.limbs.size();
+    size_t m = smaller.limbs.size();
+    result.limbs.resize(n);
+    limb b = sub_n(result.limbs.data(), larger.limbs.data(),
+                   smaller.limbs.data(), m);
+    sub_1(result.limbs.data() + m, larger.limbs.data() + m, n - m, b);
+
+    result.normalize();
+    return result;
+  };
+
+  /**
+   * @brief Adds |rhs| to |*this| in place, keeping the sign of *this.
+   * @param rhs The right-hand side bigint, which may be *this.
+   */
+  void add_abs(const bigint &rhs) {
+    add_abs(rhs.limbs.data(), rhs.limbs.size());
+  }
+
+  /**
+   * @brief Adds the m limbs at p to |*this| in place.
+   *
+   * p may only point into *this if m is not larger than its size.
+   */
+  void add_abs(const limb *p, size_t m) {
+    if (limbs.size() < m)
+      limbs.resize(m);
+    limb c = add_n(limbs.data(), limbs.data(), p, m);
+    // The carry usually dies out after a limb or two.
+    for (size_t i = m; c != 0 && i < limbs.size(); i++) {
+      limbs[i] += c;
+      c = limbs[i] == 0;
+    }
+    if (c != 0)
+      limbs.push_back(c);
+  }
+
+  /**
+   * @brief Replaces |*this| by ||*this| - |rhs|| in place, flipping the sign
+   * of *this when |rhs| is the larger one.
+   * @param rhs The right-hand side bigint, which may be *this.
+   */
+  void sub_abs(const bigint &rhs) {
+    sub_abs(rhs.limbs.data(), rhs.limbs.size());
+  }
+
+  /**
+   * @brief Replaces |*this| by ||*this| - p| in place for the m normalized
+   * limbs at p, flipping the sign of *this when p is the larger one.
+   *
+   * p may only point into *this if it is all of it.
+   */
+  void sub_abs(const limb *p, size_t m) {
+    size_t n = limbs.size();
+    if (n > m || (n == m && cmp_n(limbs.data(), p, n) >= 0)) {
+      limb b = sub_n(limbs.data(), limbs.data(), p, m);
+      for (size_t i = m; b != 0; i++) {
+        b = limbs[i] == 0;
+        limbs[i]--;
+      }
+    } else {
+      limbs.resize(m);
+      limb b = sub_n(limbs.data(), p, limbs.data(), n);
+      sub_1(limbs.data() + n, p + n, m - n, b);
+      ne = !ne;
+    }
+    normalize();
+  }
+
+  /**
+   * @brief Adds a * b to *this, the product taken as negative if neg.
+   */
+  void fused_mul(const bigint &a, const bigint &b, bool neg) {
+    BIGINT_STATS_SCOPE(thread_stats.mul, a.limbs.size() + b.limbs.size());
+    if (a.limbs.empty() || b.limbs.empty())
+      return;
+    if (this == &a || this == &b) {
+      bigint p = a * b;
+      p.ne = neg;
+      *this += p;
+      return;
+    }
+    if (limbs.empty())
+      ne = neg;
+
+    const bigint &x = a.limbs.size() < b.limbs.size() ? b : a;
+    const bigint &y = a.limbs.size() < b.limbs.size() ? a : b;
+    size_t an = x.limbs.size();
+    size_t bn = y.limbs.size();
+    if (ne == neg && bn < karatsuba_threshold) {
+      // Schoolbook rows added in place, each carry running up to the top.
+      size_t n = std::max(limbs.size(), an + bn);
+      limbs.resize(n);
+      limb *r = limbs.data();
+      limb top = 0;
+      for (size_t i = 0; i < bn; i++) {
+        limb c = addmul_1(r + i, x.limbs.data(), an, y.limbs[i]);
+        top += add_1(r + i + an, r + i + an, n - i - an, c);
+      }
+      if (top != 0)
+        limbs.push_back(top);
+      else
+        normalize();
+      return;
+    }
+
+    scratch_vector p(an + bn, scratch_resource());
+    mul_limbs(p.data(), x.limbs.data(), an, y.limbs.data(), bn);
+    size_t m = p.back() == 0 ? an + bn - 1 : an + bn;
+    if (ne == neg)
+      add_abs(p.data(), m);
+    else
+      sub_abs(p.data(), m);
+  }
+
+  /**
+   * @brief Adds one to |*this| in place.
+   */
+  void increment_abs() {
+    for (limb &l : limbs) {
+      if (++l != 0)
+        return;
+    }
+    limbs.push_back(1);
+  }
+
+  /**
+   * @brief Subtracts one from |*this| in place, which must not be zero.
+   */
+  void decrement_abs() {
+    size_t i = 0;
+    while (limbs[i] == 0)
+      limbs[i++] = ~limb(0);
+    limbs[i]--;
+    if (limbs.back() == 0)
+      limbs.pop_back();
+  }
+
+  /**
+   * @brief Compares absolute values of *this and rhs.
+   * @param rhs The right-hand side bigint.
+   * @return true if |*this| < |rhs|, false otherwise.
+   */
+  bool abs_less(const bigint &rhs) const { return cmp_abs(rhs) < 0; }
+
+  /**
+   * @brief Whether limbs are stored little endian, as the record format.
+   */
+  static constexpr bool little_endian =
+      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+  /**
+   * @brief Byte swaps n 64-bit words at p, which need not be aligned.
+   */
+  static void swap_limbs(void *p, size_t n) {
+    unsigned char *bytes = static_cast<unsigned char *>(p);
+    for (size_t i = 0; i < n; i++) {
+      limb l;
+      std::memcpy(&l, bytes + i * sizeof l, sizeof l);
+      l = __builtin_bswap64(l);
+      std::memcpy(bytes + i * sizeof l, &l, sizeof l);
+    }
+  }
+
+  /**
+   * @brief The header word of the binary record, in host byte order.
+   */
+  limb record_header() const {
+    return static_cast<limb>(limbs.size()) << 1 | (ne ? 1 : 0);
+  }
+
+  /**
+   * @brief Reads the header of the record at data.
+   * @param neg Receives the sign.
+   * @return The limb count, after checking that size bytes hold them.
+   */
+  static size_t record_limbs(const void *data, size_t size, bool &neg) {
+    limb header;
+    if (size < sizeof header)
+      throw std::invalid_argument("Truncated bigint record");
+    std::memcpy(&header, data, sizeof header);
+    if (!little_endian)
+      header = __builtin_bswap64(header);
+    limb n = header >> 1;
+    if (n > size / sizeof(limb) - 1)
+      throw std::invalid_argument("Truncated bigint record");
+    neg = (header & 1) != 0;
+    return static_cast<size_t>(n);
+  }
+
+  /**
+   * @brief Rejects records that no bigint writes: a leading zero limb or a
+   * negative zero.
+   */
+  static void check_record(const limb *p, size_t n, bool neg) {
+    if (n == 0 ? neg : p[n - 1] == 0)
+      throw std::invalid_argument("Malformed bigint record");
+  }
+
+  /**
+   * @brief The magnitude of a native integer, as a limb.
+   */
+  template <class T> static limb scalar_abs(T v) {
+    if constexpr (std::is_signed_v<T>)
+      return v < 0 ? 0 - static_cast<limb>(v) : static_cast<limb>(v);
+    else
+      return static_cast<limb>(v);
+  }
+
+  /**
+   * @brief Whether a native integer is negative.
+   */
+  template <class T> static bool scalar_neg(T v) {
+    if constexpr (std::is_signed_v<T>)
+      return v < 0;
+    else
+      return false;
+  }
+
+  /**
+   * @brief The bigint holding a native integer.
+   */
+  template <class T> static bigint from_scalar(T v) {
+    limb m = scalar_abs(v);
+    bigint result = from_limbs(&m, 1);
+    result.ne = scalar_neg(v);
+    return result;
+  }
+
+  /**
+   * @brief Cofactors of a run of Euclid's algorithm.
+   */
+  struct gcd_matrix;
+
+  /**
+   * @brief Euclid's algorithm on a > b >= 0 in place, until b < 2^stop.
+   * @param m If not null, the steps taken are appended to it.
+   */
+  static void gcd_reduce(bigint &a, bigint &b, size_t stop, gcd_matrix *m);
+
+  /**
+   * @brief One batch of gcd_reduce from the leading limb of a, in place.
+   * @return false if the batch does not carry over to the full a and b.
+   */
+  static bool lehmer_step(bigint &a, bigint &b, size_t stop, gcd_matrix *m,
+                          bigint &x, bigint &y);
+
+  /**
+   * @brief Sets *this = p * u - q * v for u, v of at most n limbs.
+   * @return false if that is negative, leaving *this undefined.
+   */
+  bool assign_mul_sub_1(const bigint &u, limb p, const bigint &v, limb q,
+                        size_t n) {
+    size_t un = u.limbs.size(), vn = v.limbs.size();
+    limbs.resize(n + 1);
+    limb *r = limbs.data();
+    r[un] = mul_1(r, u.limbs.data(), un, p);
+    std::fill(r + un + 1, r + n + 1, 0);
+    limb borrow = submul_1(r, v.limbs.data(), vn, q);
+    if (sub_1(r + vn, r + vn, n + 1 - vn, borrow) != 0)
+      return false;
+    ne = false;
+    normalize();
+    return true;
+  }
+
+  /**
+   * @brief Sets *this = p * u + q * v.
+   */
+  void assign_mul_add_1(const bigint &u, limb p, const bigint &v, limb q) {
+    size_t un = u.limbs.size(), vn = v.limbs.size();
+    size_t n = std::max(un, vn);
+    limbs.resize(n + 2);
+    limb *r = limbs.data();
+    r[un] = mul_1(r, u.limbs.data(), un, p);
+    std::fill(r + un + 1, r + n + 2, 0);
+    limb c = addmul_1(r, v.limbs.data(), vn, q);
+    r[n + 1] = add_1(r + vn, r + vn, n + 1 - vn, c);
+    ne = false;
+    normalize();
+  }
+
+  /**
+   * @brief Binary gcd of two limbs.
+   */
+  static limb gcd_1(limb a, limb b) {
+    if (a == 0 || b == 0)
+      return a | b;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+      b >>= __builtin_ctzll(b);
+      if (a > b)
+        std::swap(a, b);
+      b -= a;
+    }
+    return a << shift;
+  }
+
+  /**
+   * @brief The 64 bits of |*this| starting at bit s.
+   */
+  limb bits_at(size_t s) const {
+    size_t i = s / 64;
+    unsigned k = static_cast<unsigned>(s % 64);
+    if (i >= limbs.size())
+      return 0;
+    limb r = limbs[i] >> k;
+    if (k != 0 && i + 1 < limbs.size())
+      r |= limbs[i + 1] << (64 - k);
+    return r;
+  }
+
+  /**
+   * @brief Integer square root of n >= 0, see isqrt().
+   *
+   * a holds the square root of the leading 2d bits of n, which the division
+   * step extends to 2d bits while keeping it within one of the true value.
+   */
+  static bigint isqrt_abs(const bigint &n) {
+    if (n.limbs.size() <= 1) {
+      limb x = n.limbs.empty() ? 0 : n.limbs[0];
+      limb r = static_cast<limb>(std::sqrt(static_cast<double>(x)));
+      while (static_cast<dlimb>(r) * r > x)
+        r--;
+      while (static_cast<dlimb>(r + 1) * (r + 1) <= x)
+        r++;
+      return bigint(r);
+    }
+    size_t c = (n.bit_length_abs() - 1) / 2;
+    bigint a(1);
+    size_t d = 0;
+    for (int s = 63 - __builtin_clzll(c); s >= 0; s--) {
+      size_t e = d;
+      d = c >> s;
+      a = (std::move(a) << (d - e - 1)) + (n >> (2 * c - e - d + 1)) / a;
+    }
+    if (a.square().cmp_abs(n) > 0)
+      --a;
+    return a;
+  }
+
+  /**
+   * @brief Integer k-th root of n >= 0 for k >= 3, see iroot().
+   *
+   * Newton's iteration converges from above, so it starts just past the
+   * root of the leading bits and stops once it no longer decreases.
+   */
+  static bigint iroot_abs(const bigint &n, uint64_t k) {
+    size_t bits = n.bit_length_abs();
+    if (bits <= k)
+      return bigint(n.limbs.empty() ? 0 : 1);
+    size_t h = bits / k / 2;
+    bigint x;
+    if (h < 32)
+      x = bigint(1) << (bits / k + 1);
+    else
+      x = (iroot_abs(n >> (k * h), k) + 1) << h;
+    for (;;) {
+      bigint y = (x * (k - 1) + n / pow(x, k - 1)) / k;
+      if (y >= x)
+        return x;
+      x = std::move(y);
+    }
+  }
+
+  /**
+   * @brief Flips the sign in place, keeping zero non-negative.
+   */
+  void negate() { ne = !ne && !limbs.empty(); }
+
+  /**
+   * @brief Adds m to *this, taken as negative if neg.
+   */
+  void add_scalar(limb m, bool neg) {
+    BIGINT_STATS_SCOPE(ne == neg ? thread_stats.add : thread_stats.sub,
+                       limbs.size() + 1);
+    size_t n = limbs.size();
+    if (m == 0)
+      return;
+    if (n == 0) {
+      limbs.push_back(m);
+      ne = neg;
+    } else if (ne == neg) {
+      limb c = add_1(limbs.data(), limbs.data(), n, m);
+      if (c != 0)
+        limbs.push_back(c);
+    } else if (n > 1 || limbs[0] >= m) {
+      sub_1(limbs.data(), limbs.data(), n, m);
+      normalize();
+    } else {
+      limbs[0] = m - limbs[0];
+      ne = !ne;
+    }
+  }
+
+  /**
+   * @brief Whether any of the lowest bits bits of |*this| is set.
+   */
+  bool low_bits_nonzero(size_t bits) const {
+    size_t k = std::min(bits / 64, limbs.size());
+    for (size_t i = 0; i < k; i++) {
+      if (limbs[i] != 0)
+        return true;
+    }
+    unsigned s = static_cast<unsigned>(bits % 64);
+    return k < limbs.size() && s != 0 && (limbs[k] << (64 - s)) != 0;
+  }
+
+  /**
+   * @brief *this = op(*this, rhs) on the infinite two's complement
+   * representations, for a limb-wise op.
+   *
+   * A single pass over the limbs: negative operands are converted on the
+   * fly, as the complement of |x| - 1 with its borrow carried along, and a
+   * negative result is converted back the same way.
+   */
+  template <class Op> void bitwise(const bigint &rhs, Op op) {
+    size_t an = limbs.size();
+    size_t bn = rhs.limbs.size();
+    bool a_neg = ne;
+    bool b_neg = rhs.ne;
+    bool r_neg = op(a_neg ? ~limb(0) : 0, b_neg ? ~limb(0) : 0) != 0;
+    // One limb past the longer operand holds the sign extension.
+    size_t n = std::max(an, bn) + 1;
+    limbs.resize(n);
+    limb *a = limbs.data();
+    const limb *b = rhs.limbs.data(); // After the resize, rhs may be *this
+    limb a_borrow = 1, b_borrow = 1, r_carry = 1;
+    for (size_t i = 0; i < n; i++) {
+      limb x = i < an ? a[i] : 0;
+      if (a_neg) {
+        limb d = x - a_borrow;
+        a_borrow = x < a_borrow;
+        x = ~d;
+      }
+      limb y = i < bn ? b[i] : 0;
+      if (b_neg) {
+        limb d = y - b_borrow;
+        b_borrow = y < b_borrow;
+        y = ~d;
+      }
+      limb r = op(x, y);
+      if (r_neg) {
+        r = ~r + r_carry;
+        r_carry = r < r_carry;
+      }
+      a[i] = r;
+    }
+    ne = r_neg;
+    normalize();
+  }
+
+  /**
+   * @brief Three-way comparison of the absolute values of *this and rhs.
+   * @return Negative, zero or positive as |*this| is less, equal or greater.
+   */
+  int cmp_abs(const bigint &rhs) const {
+    // Length
+    if (limbs.size() != rhs.limbs.size())
+      return limbs.size() < rhs.limbs.size() ? -1 : 1;
+    // MSL -> LSL
+    return cmp_n(limbs.data(), rhs.limbs.data(), limbs.size());
+  }
+
+  /**
+   * @brief Removes leading zero limbs from a raw limb vector.
+   */
+  static void trim(limb_vector &l) {
+    while (!l.empty() && l.back() == 0)
+      l.pop_back();
+  }
+
+  /**
+   * @brief Normalizes by removing leading zero limbs and fixing sign for
+   * zero.
+   */
+  void normalize() {
+    while (!limbs.empty() && limbs.back() == 0) {
+      limbs.pop_back();
+    }
+
+    if (limbs.empty()) {
+      ne = false;
+    }
+  }
+
+  /**
+   * @brief Divides magnitudes, q = |a| / |b| and r = |a| % |b|.
+   *
+   * q and r come out non-negative and must not alias a or b. b must not be
+   * zero.
+   */
+  static void divmod_abs(const bigint &a, const bigint &b, bigint &q,
+                         bigint &r) {
+    size_t an = a.limbs.size();
+    size_t bn = b.limbs.size();
+    if (bn >= burnikel_ziegler_threshold && an >= bn &&
+        an - bn >= burnikel_ziegler_threshold)
+      div_burnikel_ziegler(a, b, q, r);
+    else
+      divmod_basecase(a, b, q, r);
+  }
+
+  /**
+   * @brief divmod_abs without the recursive algorithm.
+   */
+  static void divmod_basecase(const bigint &a, const bigint &b, bigint &q,
+                              bigint &r) {
+    size_t an = a.limbs.size();
+    size_t bn = b.limbs.size();
+    q = bigint();
+    r = bigint();
+    if (a.abs_less(b)) {
+      r.limbs = a.limbs;
+      return;
+    }
+
+    BIGINT_STATS_SCOPE(bn == 1 ? thread_stats.div_1 : thread_stats.div_knuth,
+                       an + bn);
+    q.limbs.resize(an - bn + 1);
+    if (bn == 1) {
+      limb rem = divmod_1(q.limbs.data(), a.limbs.data(), an, b.limbs[0]);
+      if (rem != 0)
+        r.limbs.push_back(rem);
+    } else {
+      r.limbs.resize(bn);
+      div_knuth(q.limbs.data(), r.limbs.data(), a.limbs.data(), an,
+                b.limbs.data(), bn);
+      r.normalize();
+    }
+    q.normalize();
+  }
+
+  /**
+   * @brief Burnikel-Ziegler division of non-negative a by b.
+   *
+   * The divisor is shifted until its limb count is j * 2^k with j below
+   * burnikel_ziegler_threshold and its top bit set. The dividend, shifted by
+   * the same amount, is then consumed in blocks of that many limbs by
+   * div_2n_1n, which recurses on halves down to Knuth's algorithm D.
+   */
+  static void div_burnikel_ziegler(const bigint &a, const bigint &b,
+                                   bigint &q, bigint &r) {
+    BIGINT_STATS_SCOPE(thread_stats.div_burnikel_ziegler,
+                       a.limbs.size() + b.limbs.size());
+    size_t bn = b.limbs.size();
+    size_t m = 1;
+    while (bn / m >= burnikel_ziegler_threshold)
+      m *= 2;
+    size_t n = (bn + m - 1) / m * m;
+    size_t shift = (n - bn) * 64 +
+                   static_cast<size_t>(__builtin_clzll(b.limbs.back()));
+
+    bigint nb(b), na(a);
+    nb.ne = na.ne = false;
+    nb.shl_abs(shift);
+    na.shl_abs(shift);
+
+    // Blocks of n limbs, with at least one spare bit on top so that the top
+    // block is below the divisor.
+    size_t bits = na.bit_length_abs() + 1;
+    size_t t = std::max<size_t>(2, (bits + 64 * n - 1) / (64 * n));
+
+    q = bigint();
+    bigint z = limb_slice(na, (t - 2) * n, t * n);
+    for (size_t i = t - 1; i-- > 0;) {
+      bigint qi, ri;
+      div_2n_1n(z, nb, n, qi, ri);
+      q.shl_abs(64 * n);
+      q += qi;
+      if (i > 0) {
+        ri.shl_abs(64 * n);
+        z = ri + limb_slice(na, (i - 1) * n, i * n);
+      } else {
+        r = ri;
+      }
+    }
+    r.shr_abs(shift);
+  }
+
+  /**
+   * @brief Divides a 2n-limb a by an n-limb b, requiring a < b * B^n and the
+   * top bit of b to be set.
+   */
+  static void div_2n_1n(const bigint &a, const bigint &b, size_t n, bigint &q,
+                        bigint &r) {
+    if (n % 2 != 0 || n < burnikel_ziegler_threshold) {
+      divmod_basecase(a, b, q, r);
+      return;
+    }
+
+    size_t h = n / 2;
+    bigint q1, r1;
+    div_3n_2n(limb_slice(a, h, 4 * h), b, h, q1, r1);
+    r1.shl_abs(64 * h);
+    r1 += limb_slice(a, 0, h);
+    div_3n_2n(r1, b, h, q, r);
+    q1.shl_abs(64 * h);
+    q += q1;
+  }
+
+  /**
+   * @brief Divides a 3n-limb a by a 2n-limb b, with the same requirements
+   * as div_2n_1n.
+   */
+  static void div_3n_2n(const bigint &a, const bigint &b, size_t n, bigint &q,
+                        bigint &r) {
+    bigint a12 = limb_slice(a, n, 3 * n);
+    bigint b1 = limb_slice(b, n, 2 * n);
+    bigint r1;
+    if (limb_slice(a, 2 * n, 3 * n) < b1) {
+      div_2n_1n(a12, b1, n, q, r1);
+    } else {
+      // The quotient estimate would overflow, B^n - 1 is at most two too
+      // large here.
+      q = bigint();
+      q.limbs.resize(n);
+      std::fill(q.limbs.begin(), q.limbs.end(), ~limb(0));
+      r1 = b1;
+      r1.shl_abs(64 * n);
+      r1 = a12 - r1 + b1;
+    }
+
+    r1.shl_abs(64 * n);
+    r1 += limb_slice(a, 0, n);
+    r = r1 - q * limb_slice(b, 0, n);
+    while (r.ne) {
+      r += b;
+      --q;
+    }
+  }
+
+  /**
+   * @brief The non-negative number formed by limbs [lo, hi) of x, clamped
+   * to its size.
+   */
+  static bigint limb_slice(const bigint &x, size_t lo, size_t hi) {
+    size_t n = x.limbs.size();
+    lo = std::min(lo, n);
+    return from_limbs(x.limbs.data() + lo, std::min(hi, n) - lo);
+  }
+
+  /**
+   * @brief Number of significant bits of |*this|.
+   */
+  size_t bit_length_abs() const {
+    if (limbs.empty())
+      return 0;
+    return 64 * limbs.size() -
+           static_cast<size_t>(__builtin_clzll(limbs.back()));
+  }
+
+  /**
+   * @brief Shifts |*this| left by the given number of bits in place.
+   */
+  void shl_abs(size_t bits) {
+    if (limbs.empty() || bits == 0)
+      return;
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    size_t n = limbs.size();
+    // A new top limb is only needed if the high s bits of the old one are
+    // set, so that shifting a temporary by a few bits can stay in place.
+    bool spill = s != 0 && (limbs[n - 1] >> (64 - s)) != 0;
+    limbs.resize(n + k + spill);
+    limb *p = limbs.data();
+    if (s != 0) {
+      limb c = lshift(p + k, p, n, s);
+      if (spill)
+        p[n + k] = c;
+    } else {
+      std::copy_backward(p, p + n, p + n + k);
+    }
+    std::fill(p, p + k, 0);
+  }
+
+  /**
+   * @brief Shifts |*this| right by the given number of bits in place,
+   * discarding the bits shifted out.
+   */
+  void shr_abs(size_t bits) {
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    size_t n = limbs.size();
+    if (k >= n) {
+      limbs.clear();
+      normalize();
+      return;
+    }
+    limb *p = limbs.data();
+    if (s != 0)
+      rshift(p, p + k, n - k, s);
+    else
+      std::copy(p + k, p + n, p);
+    limbs.resize(n - k);
+    normalize();
+  }
+
+  /**
+   * @brief The power chunk_of(base).base^(2^i), from power_cache.
+   *
+   * A missing entry is computed from the one below and published with a
+   * compare-and-swap. Threads racing on the same entry may each compute it,
+   * but all of them return the one that got published first.
+   */
+  static const bigint &radix_power(unsigned base, size_t i) {
+    std::atomic<const bigint *> &slot = power_cache[base][i];
+    if (const bigint *cached = slot.load(std::memory_order_acquire))
+      return *cached;
+
+    // The entries outlive any memory resource bound to this thread.
+    scoped_memory_resource heap(nullptr);
+    std::unique_ptr<bigint> power;
+    if (i == 0) {
+      limb chunk = chunk_of(base).base;
+      power = std::make_unique<bigint>(from_limbs(&chunk, 1));
+    } else {
+      power = std::make_unique<bigint>(radix_power(base, i - 1).square());
+    }
+    const bigint *expected = nullptr;
+    if (slot.compare_exchange_strong(expected, power.get(),
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire))
+      return *power.release();
+    return *expected;
+  }
+
+  static void check_base(unsigned base) {
+    if (base < 2 || base > max_base)
+      throw std::invalid_argument("Base must be between 2 and 36");
+  }
+
+  /**
+   * @brief Value of a digit character, max_base if it is not one.
+   */
+  static constexpr unsigned digit_value(char c) {
+    if (c >= '0' && c <= '9')
+      return static_cast<unsigned>(c - '0');
+    if (c >= 'a' && c <= 'z')
+      return static_cast<unsigned>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'Z')
+      return static_cast<unsigned>(c - 'A' + 10);
+    return max_base;
+  }
+
+  /**
+   * @brief An upper bound of the digits of |*this| in the base.
+   */
+  size_t max_digits(unsigned base) const {
+    if ((base & (base - 1)) == 0) {
+      size_t bits = static_cast<size_t>(__builtin_ctz(base));
+      return std::max<size_t>(1, (bit_length_abs() + bits - 1) / bits);
+    }
+    return (chunk_of(base).digits + 1) * limbs.size() + 1;
+  }
+
+  /**
+   * @brief Writes exactly digits digits of v to out.
+   */
+  static void put_chunk(limb v, unsigned base, size_t digits, char *out) {
+    // A separate loop for base 10, so that its divisions become
+    // multiplications.
+    if (base == 10) {
+      for (size_t i = digits; i-- > 0; v /= 10)
+        out[i] = static_cast<char>('0' + v % 10);
+    } else {
+      for (size_t i = digits; i-- > 0; v /= base)
+        out[i] = "0123456789abcdefghijklmnopqrstuvwxyz"[v % base];
+    }
+  }
+
+  /**
+   * @brief Writes the digits of |*this| in a power of two base to
+   * [first, last), one bit field per digit.
+   * @return The end of the digits, nullptr if they do not fit.
+   */
+  char *write_pow2(unsigned base, char *first, char *last) const {
+    size_t bits = static_cast<size_t>(__builtin_ctz(base));
+    size_t digits = max_digits(base);
+    if (static_cast<size_t>(last - first) < digits)
+      return nullptr;
+    for (size_t i = 0; i < digits; i++) {
+      limb d = bits_at(i * bits) & (base - 1);
+      first[digits - 1 - i] = "0123456789abcdefghijklmnopqrstuvwxyz"[d];
+    }
+    return first + digits;
+  }
+
+  /**
+   * @brief Writes the digits of the non-negative x in a base that is not a
+   * power of two to [first, last), without leading zeros.
+   * @return The end of the digits, nullptr if they do not fit.
+   *
+   * Large x are split as q * P + r by the largest power P =
+   * radix_power(base, k) of at most about half its limbs, so that q is not
+   * zero, and r is written padded to the digits of P.
+   */
+  static char *write_radix(const bigint &x, unsigned base, char *first,
+                           char *last) {
+    radix_chunk c = chunk_of(base);
+    size_t n = x.limbs.size();
+    if (n < decimal_basecase_limbs) {
+      // Base 3 has the most digits per limb here, under 41.
+      char buf[41 * decimal_basecase_limbs];
+      size_t pos = sizeof buf;
+      limb_vector t = x.limbs;
+      while (n > 0) {
+        limb chunk = divmod_1(t.data(), t.data(), n, c.base);
+        while (n > 0 && t[n - 1] == 0)
+          n--;
+        pos -= c.digits;
+        put_chunk(chunk, base, c.digits, buf + pos);
+      }
+      while (pos < sizeof buf - 1 && buf[pos] == '0')
+        pos++;
+      if (pos == sizeof buf)
+        buf[--pos] = '0';
+      size_t len = sizeof buf - pos;
+      if (static_cast<size_t>(last - first) < len)
+        return nullptr;
+      return std::copy(buf + pos, buf + sizeof buf, first);
+    }
+
+    size_t k = 1;
+    while (2 * radix_power(base, k + 1).limbs.size() <= n + 1)
+      k++;
+    bigint q, r;
+    divmod_abs(x, radix_power(base, k), q, r);
+    char *out = write_radix(q, base, first, last);
+    size_t width = c.digits << k;
+    if (!out || static_cast<size_t>(last - out) < width)
+      return nullptr;
+    to_radix(r, base, k - 1, out);
+    return out + width;
+  }
+
+  /**
+   * @brief Writes exactly d * 2^(k + 1) digits of the non-negative x in the
+   * base, padded with leading zeros, to out, d being chunk_of(base).digits.
+   *
+   * The caller ensures x < base^(d * 2^(k + 1)).
+   */
+  static void to_radix(const bigint &x, unsigned base, size_t k, char *out) {
+    radix_chunk c = chunk_of(base);
+    size_t width = c.digits << (k + 1);
+    if (x.limbs.size() < decimal_basecase_limbs) {
+      limb_vector t = x.limbs;
+      size_t n = t.size();
+      size_t pos = width;
+      while (n > 0) {
+        limb chunk = divmod_1(t.data(), t.data(), n, c.base);
+        while (n > 0 && t[n - 1] == 0)
+          n--;
+        pos -= c.digits;
+        put_chunk(chunk, base, c.digits, out + pos);
+      }
+      std::fill(out, out + pos, '0');
+      return;
+    }
+
+    bigint q, r;
+    divmod_abs(x, radix_power(base, k), q, r);
+    to_radix(q, base, k - 1, out);
+    to_radix(r, base, k - 1, out + width / 2);
+  }
+
+  /**
+   * @brief Builds a non-negative bigint from a slice of limbs.
+   * @param p The least significant limb.
+   * @param n The number of limbs.
+   */
+  static bigint from_limbs(const limb *p, size_t n) {
+    bigint result;
+    result.limbs.assign(p, p + n);
+    result.normalize();
+    return result;
+  }
+
+  /**
+   * @brief Multiplies v down to a single value with a balanced product
+   * tree, consuming it.
+   */
+  static bigint product_tree(std::vector<bigint> &v) {
+    if (v.empty())
+      return bigint(1);
+    while (v.size() > 1) {
+      size_t pairs = v.size() / 2;
+      size_t level_limbs = 0;
+      for (const bigint &x : v)
+        level_limbs += x.limbs.size();
+      parallel_for(pairs, level_limbs,
+                   [&](size_t i) { v[2 * i] *= v[2 * i + 1]; });
+      for (size_t i = 0; i < pairs; i++)
+        v[i] = std::move(v[2 * i]);
+      if (v.size() % 2 != 0)
+        v[pairs] = std::move(v.back());
+      v.resize((v.size() + 1) / 2);
+    }
+    return std::move(v[0]);
+  }
+
+  /**
+   * @brief Product of the given limbs, which are first packed into as few
+   * single-limb leaves as fit, then multiplied with product_tree.
+   */
+  static bigint product_of_limbs(const std::vector<limb> &factors) {
+    std::vector<bigint> leaves;
+    limb acc = 1;
+    for (limb f : factors) {
+      dlimb t = static_cast<dlimb>(acc) * f;
+      if ((t >> 64) != 0) {
+        leaves.push_back(from_limbs(&acc, 1));
+        acc = f;
+      } else {
+        acc = static_cast<limb>(t);
+      }
+    }
+    leaves.push_back(from_limbs(&acc, 1));
+    return product_tree(leaves);
+  }
+
+  /**
+   * @brief The primes up to n, in increasing order, from a sieve over the
+   * odd numbers.
+   */
+  static std::vector<limb> primes_up_to(uint64_t n) {
+    std::vector<limb> primes;
+    if (n < 2)
+      return primes;
+    primes.push_back(2);
+    // Entry i stands for 2i + 1.
+    std::vector<bool> composite(static_cast<size_t>(n / 2 + 1));
+    for (uint64_t i = 1; 2 * i + 1 <= n; i++) {
+      if (composite[i])
+        continue;
+      uint64_t p = 2 * i + 1;
+      primes.push_back(p);
+      for (uint64_t j = p * p; j <= n; j += 2 * p)
+        composite[j / 2] = true;
+    }
+    return primes;
+  }
+
+  /**
+   * @brief The odd part of n!, recursively from that of (n/2)! and the odd
+   * prime powers of swing(n) = n! / ((n/2)!)^2.
+   */
+  static bigint odd_factorial(uint64_t n, const std::vector<limb> &primes) {
+    if (n < 3)
+      return bigint(1);
+    bigint result = odd_factorial(n / 2, primes).square();
+    std::vector<limb> factors;
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; i++) {
+      limb p = primes[i];
+      limb f = 1;
+      for (uint64_t q = n / p; q != 0; q /= p) {
+        if (q & 1)
+          f *= p;
+      }
+      if (f != 1)
+        factors.push_back(f);
+    }
+    result *= product_of_limbs(factors);
+    return result;
+  }
+
+  /**
+   * @brief Divides *this by d in place, assuming the division is exact.
+   * @param d The non-zero limb to divide by.
+   */
+  void div_exact_1(limb d) {
+    divmod_1(limbs.data(), limbs.data(), limbs.size(), d);
+    normalize();
+  }
+
+  /**
+   * @brief Checks that all len characters at p are decimal digits.
+   *
+   * Eight characters are tested at once as one 64-bit word: a byte is a
+   * digit iff neither adding 0x46 nor subtracting 0x30 sets its top bit.
+   */
+  static bool all_digits(const char *p, size_t len) {
+    size_t i = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 8 <= len; i += 8) {
+      uint64_t w;
+      std::memcpy(&w, p + i, 8);
+      if (((w + 0x4646464646464646ull) | (w - 0x3030303030303030ull)) &
+          0x8080808080808080ull)
+        return false;
+    }
+#endif
+    for (; i < len; i++) {
+      if (p[i] < '0' || p[i] > '9')
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Value of up to chunk_of(base).digits validated digits.
+   */
+  static limb parse_chunk(const char *p, size_t len, unsigned base) {
+    limb v = 0;
+    if (base != 10) {
+      for (size_t i = 0; i < len; i++)
+        v = v * base + digit_value(p[i]);
+      return v;
+    }
+    size_t i = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Combine eight digits with three multiplications: pairs of digits,
+    // then pairs of pairs, then the two halves. The first digit sits in the
+    // lowest byte.
+    for (; i + 8 <= len; i += 8) {
+      uint64_t w;
+      std::memcpy(&w, p + i, 8);
+      w = (w & 0x0f0f0f0f0f0f0f0full) * 2561 >> 8;
+      w = (w & 0x00ff00ff00ff00ffull) * 6553601 >> 16;
+      w = (w & 0x0000ffff0000ffffull) * 42949672960001ull >> 32;
+      v = v * 100000000 + static_cast<uint32_t>(w);
+    }
+#endif
+    for (; i < len; i++)
+      v = v * 10 + static_cast<limb>(p[i] - '0');
+    return v;
+  }
+
+  /**
+   * @brief Sets |*this| to the value of len validated digits in the base,
+   * a chunk of digits that fits in a limb per pass over the limbs.
+   */
+  void parse_basecase(const char *p, size_t len, unsigned base) {
+    radix_chunk c = chunk_of(base);
+    limbs.clear();
+    limbs.reserve(len / c.digits + 1);
+    // A short leading chunk, so that the rest are whole.
+    size_t head = len % c.digits;
+    if (head != 0)
+      limbs.push_back(parse_chunk(p, head, base));
+    for (size_t i = head; i < len; i += c.digits)
+      mul_add_1(c.base, parse_chunk(p + i, c.digits, base));
+  }
+
+  /**
+   * @brief The non-negative value of len validated digits in a base that
+   * is not a power of two.
+   *
+   * Splits off the low d * 2^k digits, d being chunk_of(base).digits and k
+   * the largest for which the high part is not shorter, so that the powers
+   * come from the same table as for to_radix().
+   */
+  static bigint from_radix(const char *p, size_t len, unsigned base) {
+    bigint result;
+    size_t d = chunk_of(base).digits;
+    if (len <= d * decimal_basecase_limbs) {
+      result.parse_basecase(p, len, base);
+      result.normalize();
+      return result;
+    }
+
+    size_t k = 0;
+    while (d << (k + 1) < len)
+      k++;
+    size_t low = d << k;
+    result = from_radix(p, len - low, base) * radix_power(base, k);
+    result += from_radix(p + len - low, low, base);
+    return result;
+  }
+
+  /**
+   * @brief The non-negative value of len validated digits in a power of two
+   * base, packed from the last digit up into one limb at a time.
+   */
+  static bigint from_pow2(const char *p, size_t len, unsigned base) {
+    unsigned bits = static_cast<unsigned>(__builtin_ctz(base));
+    bigint result;
+    result.limbs.resize((len * bits + 63) / 64);
+    limb *r = result.limbs.data();
+    limb acc = 0;
+    unsigned used = 0;
+    size_t i = len;
+    if (64 % bits == 0) {
+      // Whole limbs of digits, without a straddling one to check.
+      size_t per = 64 / bits;
+      for (; i >= per; i -= per, r++)
+        for (size_t j = 0; j < per; j++)
+          *r |= static_cast<limb>(digit_value(p[i - 1 - j])) << (j * bits);
+    }
+    while (i-- > 0) {
+      limb v = digit_value(p[i]);
+      acc |= v << used;
+      used += bits;
+      if (used >= 64) {
+        // The high bits of a digit that straddles two limbs start the next.
+        *r++ = acc;
+        used -= 64;
+        acc = used != 0 ? v >> (bits - used) : 0;
+      }
+    }
+    if (used != 0)
+      *r = acc;
+    result.normalize();
+    return result;
+  }
+
+  /**
+   * @brief Computes |*this| = |*this| * m + a in place.
+   * @param m The limb to multiply by.
+   * @param a The limb to add.
+   */
+  void mul_add_1(limb m, limb a) {
+    for (limb &l : limbs) {
+      dlimb t = static_cast<dlimb>(l) * m + a;
+      l = static_cast<limb>(t);
+      a = static_cast<limb>(t >> 64);
+    }
+    if (a != 0)
+      limbs.push_back(a);
+  }
+
+  /*
+   * Limb kernels. They work on raw little-endian limb ranges so that the
+   * higher level algorithms can run them on slices of a number without
+   * copying. The destination may alias either source as long as it does not
+   * start after it.
+   */
+
+  /**
+   * @brief r = a + b over n limbs.
+   * @return The carry out of the top limb.
+   *
+   * On x86-64 blocks of four limbs go through one unrolled adc chain, which
+   * keeps the carry in the flags register; the rest is the portable loop.
+   */
+  static limb add_n(limb *r, const limb *a, const limb *b, size_t n) {
+    limb c = 0;
+#if defined(__x86_64__)
+    if (size_t blocks = n / 4) {
+      // dec and lea leave the carry flag alone between iterations.
+      __asm__("xorl %k[c], %k[c]\n\t"
+              "1:\n\t"
+              "movq (%[a]), %%r8\n\t"
+              "movq 8(%[a]), %%r9\n\t"
+              "movq 16(%[a]), %%r10\n\t"
+              "movq 24(%[a]), %%r11\n\t"
+              "adcq (%[b]), %%r8\n\t"
+              "adcq 8(%[b]), %%r9\n\t"
+              "adcq 16(%[b]), %%r10\n\t"
+              "adcq 24(%[b]), %%r11\n\t"
+              "movq %%r8, (%[r])\n\t"
+              "movq %%r9, 8(%[r])\n\t"
+              "movq %%r10, 16(%[r])\n\t"
+              "movq %%r11, 24(%[r])\n\t"
+              "leaq 32(%[a]), %[a]\n\t"
+              "leaq 32(%[b]), %[b]\n\t"
+              "leaq 32(%[r]), %[r]\n\t"
+              "decq %[k]\n\t"
+              "jnz 1b\n\t"
+              "setc %b[c]"
+              : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [k] "+r"(blocks),
+                [c] "=&r"(c)
+              :
+              : "r8", "r9", "r10", "r11", "cc", "memory");
+      n %= 4;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+      limb s = a[i] + c;
+      c = s < c;
+      s += b[i];
+      c += s < b[i];
+      r[i] = s;
+    }
+    return c;
+  }
+
+  /**
+   * @brief r = a + c over n limbs, for a single limb c.
+   * @return The carry out of the top limb.
+   *
+   * Stops propagating as soon as the carry dies out, the remaining limbs are
+   * only copied, and not even that when r is a.
+   */
+  static limb add_1(limb *r, const limb *a, size_t n, limb c) {
+    size_t i = 0;
+    for (; i < n && c != 0; i++) {
+      r[i] = a[i] + c;
+      c = r[i] < c;
+    }
+    if (r != a)
+      std::copy(a + i, a + n, r + i);
+    return c;
+  }
+
+  /**
+   * @brief r = a - b over n limbs.
+   * @return The borrow out of the top limb.
+   *
+   * The x86-64 path mirrors add_n with an sbb chain.
+   */
+  static limb sub_n(limb *r, const limb *a, const limb *b, size_t n) {
+    limb c = 0;
+#if defined(__x86_64__)
+    if (size_t blocks = n / 4) {
+      __asm__("xorl %k[c], %k[c]\n\t"
+              "1:\n\t"
+              "movq (%[a]), %%r8\n\t"
+              "movq 8(%[a]), %%r9\n\t"
+              "movq 16(%[a]), %%r10\n\t"
+              "movq 24(%[a]), %%r11\n\t"
+              "sbbq (%[b]), %%r8\n\t"
+              "sbbq 8(%[b]), %%r9\n\t"
+              "sbbq 16(%[b]), %%r10\n\t"
+              "sbbq 24(%[b]), %%r11\n\t"
+              "movq %%r8, (%[r])\n\t"
+              "movq %%r9, 8(%[r])\n\t"
+              "movq %%r10, 16(%[r])\n\t"
+              "movq %%r11, 24(%[r])\n\t"
+              "leaq 32(%[a]), %[a]\n\t"
+              "leaq 32(%[b]), %[b]\n\t"
+              "leaq 32(%[r]), %[r]\n\t"
+              "decq %[k]\n\t"
+              "jnz 1b\n\t"
+              "setc %b[c]"
+              : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [k] "+r"(blocks),
+                [c] "=&r"(c)
+              :
+              : "r8", "r9", "r10", "r11", "cc", "memory");
+      n %= 4;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+      limb d = a[i] - b[i];
+      limb b1 = a[i] < b[i];
+      r[i] = d - c;
+      c = b1 + (d < c);
+    }
+    return c;
+  }
+
+  /**
+   * @brief r = a - c over n limbs, for a single limb c.
+   * @return The borrow out of the top limb.
+   *
+   * Like add_1, stops once the borrow is absorbed.
+   */
+  static limb sub_1(limb *r, const limb *a, size_t n, limb c) {
+    size_t i = 0;
+    for (; i < n && c != 0; i++) {
+      limb d = a[i] - c;
+      c = a[i] < c;
+      r[i] = d;
+    }
+    if (r != a)
+      std::copy(a + i, a + n, r + i);
+    return c;
+  }
+
+  /**
+   * @brief r = |a - b| for an >= bn, b being zero-extended to an limbs.
+   * @return True if b > a.
+   */
+  static bool abs_diff(limb *r, const limb *a, size_t an, const limb *b,
+                       size_t bn) {
+    int cmp = 0;
+    for (size_t i = an; i > bn && cmp == 0; i--)
+      cmp = a[i - 1] != 0;
+    if (cmp == 0)
+      cmp = cmp_n(a, b, bn);
+
+    if (cmp >= 0) {
+      limb c = sub_n(r, a, b, bn);
+      sub_1(r + bn, a + bn, an - bn, c);
+      return false;
+    }
+    // b > a means the top an - bn limbs of a are zero.
+    sub_n(r, b, a, bn);
+    std::fill(r + bn, r + an, 0);
+    return true;
+  }
+
+  /**
+   * @brief Compares two n-limb magnitudes.
+   * @return Negative, zero or positive as a is less, equal or greater than b.
+   */
+  static int cmp_n(const limb *a, const limb *b, size_t n) {
+    for (size_t i = n; i > 0; i--) {
+      if (a[i - 1] != b[i - 1])
+        return a[i - 1] < b[i - 1] ? -1 : 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief r = a * b over n limbs, for a single limb b.
+   * @return The limb carried out of r[n - 1].
+   */
+  static limb mul_1(limb *r, const limb *a, size_t n, limb b) {
+#ifdef BIGINT_COMPILED_KERNELS
+    return bigint_mul_1(r, a, n, b);
+#else
+    limb c = 0;
+    for (size_t i = 0; i < n; i++) {
+      dlimb t = static_cast<dlimb>(a[i]) * b + c;
+      r[i] = static_cast<limb>(t);
+      c = static_cast<limb>(t >> 64);
+    }
+    return c;
+#endif
+  }
+
+  /**
+   * @brief r += a * b over n limbs, for a single limb b.
+   * @return The limb carried out of r[n - 1].
+   */
+  static limb addmul_1(limb *r, const limb *a, size_t n, limb b) {
+#ifdef BIGINT_COMPILED_KERNELS
+    return bigint_addmul_1(r, a, n, b);
+#else
+    limb c = 0;
+    for (size_t i = 0; i < n; i++) {
+      dlimb t = static_cast<dlimb>(a[i]) * b + r[i] + c;
+      r[i] = static_cast<limb>(t);
+      c = static_cast<limb>(t >> 64);
+    }
+    return c;
+#endif
+  }
+
+  /**
+   * @brief q = a / d over n limbs, for a single non-zero limb d.
+   * @return The remainder a % d.
+   */
+  static limb divmod_1(limb *q, const limb *a, size_t n, limb d) {
+    limb r = 0;
+    for (size_t i = n; i > 0; i--)
+      q[i - 1] = div_2by1(r, a[i - 1], d, r);
+    return r;
+  }
+
+  /**
+   * @brief Divides the two-limb value hi * 2^64 + lo by d, requiring hi < d
+   * so that the quotient fits in a limb.
+   * @param rem Receives the remainder.
+   * @return The quotient.
+   */
+  static limb div_2by1(limb hi, limb lo, limb d, limb &rem) {
+#if defined(__x86_64__)
+    // A single divq, where the generic 128-bit division is a library call.
+    limb q;
+    __asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+    return q;
+#else
+    dlimb t = (static_cast<dlimb>(hi) << 64) | lo;
+    rem = static_cast<limb>(t % d);
+    return static_cast<limb>(t / d);
+#endif
+  }
+
+  /**
+   * @brief r -= a * b over n limbs, for a single limb b.
+   * @return The limb borrowed out of r[n - 1].
+   */
+  static limb submul_1(limb *r, const limb *a, size_t n, limb b) {
+    limb c = 0;
+    for (size_t i = 0; i < n; i++) {
+      dlimb t = static_cast<dlimb>(a[i]) * b + c;
+      limb lo = static_cast<limb>(t);
+      c = static_cast<limb>(t >> 64);
+      limb ri = r[i];
+      r[i] = ri - lo;
+      c += ri < lo;
+    }
+    return c;
+  }
+
+  /**
+   * @brief r = a << s over n limbs, for 0 < s < 64. r may equal a.
+   * @return The bits shifted out of the top limb.
+   */
+  static limb lshift(limb *r, const limb *a, size_t n, unsigned s) {
+    limb out = a[n - 1] >> (64 - s);
+    for (size_t i = n - 1; i > 0; i--)
+      r[i] = (a[i] << s) | (a[i - 1] >> (64 - s));
+    r[0] = a[0] << s;
+    return out;
+  }
+
+  /**
+   * @brief r = a >> s over n limbs, for 0 < s < 64. r may equal a.
+   * @return The bits shifted out of the bottom limb, in the high bits.
+   */
+  static limb rshift(limb *r, const limb *a, size_t n, unsigned s) {
+    limb out = a[0] << (64 - s);
+    for (size_t i = 0; i + 1 < n; i++)
+      r[i] = (a[i] >> s) | (a[i + 1] << (64 - s));
+    r[n - 1] = a[n - 1] >> s;
+    return out;
+  }
+
+  /**
+   * @brief Knuth's algorithm D, q = u / v and r = u % v.
+   *
+   * Requires un >= vn >= 2 and v[vn - 1] != 0. q receives un - vn + 1 limbs
+   * and r receives vn limbs. Neither may overlap the inputs.
+   */
+  static void div_knuth(limb *q, limb *r, const limb *u, size_t un,
+                        const limb *v, size_t vn) {
+    // Normalize so that the top bit of the divisor is set, which keeps every
+    // estimated quotient limb at most two too large.
+    unsigned s = static_cast<unsigned>(__builtin_clzll(v[vn - 1]));
+    scratch_vector nv(v, v + vn, scratch_resource());
+    scratch_vector nu(un + 1, scratch_resource());
+    std::copy(u, u + un, nu.begin());
+    if (s != 0) {
+      lshift(nv.data(), nv.data(), vn, s);
+      nu[un] = lshift(nu.data(), nu.data(), un, s);
+    }
+
+    limb vtop = nv[vn - 1];
+    limb vnext = nv[vn - 2];
+    for (size_t j = un - vn + 1; j-- > 0;) {
+      limb *w = nu.data() + j;
+      limb qhat, rhat;
+      bool big_rhat = false; // rhat no longer fits in a limb
+      if (w[vn] >= vtop) {
+        qhat = ~limb(0);
+        rhat = w[vn - 1] + vtop;
+        big_rhat = rhat < vtop;
+      } else {
+        qhat = div_2by1(w[vn], w[vn - 1], vtop, rhat);
+      }
+      while (!big_rhat && static_cast<dlimb>(qhat) * vnext >
+                              ((static_cast<dlimb>(rhat) << 64) | w[vn - 2])) {
+        qhat--;
+        rhat += vtop;
+        big_rhat = rhat < vtop;
+      }
+
+      limb b = submul_1(w, nv.data(), vn, qhat);
+      limb top = w[vn];
+      w[vn] = top - b;
+      if (top < b) {
+        // Rare: qhat was still one too large, add the divisor back.
+        qhat--;
+        w[vn] += add_n(w, w, nv.data(), vn);
+      }
+      q[j] = qhat;
+    }
+
+    if (s != 0)
+      rshift(r, nu.data(), vn, s);
+    else
+      std::copy(nu.begin(), nu.begin() + vn, r);
+  }
+
+  /**
+   * @brief Calls f(i) for i in [0, k), spread over the threads of the
+   * current multiplication when size reaches parallel_threshold.
+   *
+   * Returns once all calls have finished, rethrowing the first exception.
+   * With w workers, worker j runs calls j, j + w, ... and hands each of them
+   * its share of the thread budget for nested splits. Worker 0 is the
+   * calling thread, which afterwards runs any other worker that has not
+   * started yet instead of waiting for it.
+   */
+  template <class F>
+  static void parallel_for(size_t k, size_t size, const F &f) {
+    size_t budget = thread_share != 0 ? thread_share : mul_threads;
+    size_t w = size >= parallel_threshold ? std::min(k, budget) : 1;
+    if (w <= 1) {
+      for (size_t i = 0; i < k; i++)
+        f(i);
+      return;
+    }
+
+    // Shared with the launched tasks, which may only get to run after this
+    // call has returned, and then find their worker already claimed.
+    struct state {
+      std::unique_ptr<std::atomic<bool>[]> claimed;
+      std::mutex mutex;
+      std::condition_variable cv;
+      size_t done = 0;
+      std::exception_ptr error;
+    };
+    auto st = std::make_shared<state>();
+    st->claimed.reset(new std::atomic<bool>[w]());
+    size_t share = budget / w;
+    auto work = [st, &f, k, w, share](size_t j) {
+      if (st->claimed[j].exchange(true))
+        return;
+      std::exception_ptr error;
+      size_t saved = thread_share;
+      thread_share = share;
+      try {
+        for (size_t i = j; i < k; i += w)
+          f(i);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      thread_share = saved;
+      std::lock_guard<std::mutex> lock(st->mutex);
+      if (error && !st->error)
+        st->error = error;
+      st->done++;
+      st->cv.notify_all();
+    };
+
+    std::vector<std::thread> threads;
+    try {
+      for (size_t j = 1; j < w; j++) {
+        std::function<void()> task = [work, j] { work(j); };
+        if (mul_executor)
+          mul_executor(std::move(task));
+        else
+          threads.emplace_back(std::move(task));
+      }
+    } catch (...) {
+      // Workers that could not be launched are run below like any other
+      // that has not started yet.
+    }
+    for (size_t j = 0; j < w; j++)
+      work(j);
+    {
+      std::unique_lock<std::mutex> lock(st->mutex);
+      st->cv.wait(lock, [&] { return st->done == w; });
+    }
+    for (std::thread &t : threads)
+      t.join();
+    if (st->error)
+      std::rethrow_exception(st->error);
+  }
+
+  /**
+   * @brief Schoolbook multiplication, r = a * b.
+   *
+   * r must have room for an + bn limbs and must not overlap a or b.
+   */
+  static void mul_basecase(limb *r, const limb *a, size_t an, const limb *b,
+                           size_t bn) {
+    BIGINT_STATS_SCOPE(thread_stats.mul_schoolbook, an + bn);
+    std::fill(r, r + an + bn, 0);
+    for (size_t i = 0; i < bn; i++) {
+      r[an + i] = addmul_1(r + i, a, an, b[i]);
+    }
+  }
+
+  /**
+   * @brief Multiplication dispatch, r = a * b.
+   *
+   * Requires an >= bn >= 1. r must have room for an + bn limbs and must not
+   * overlap a or b. The algorithm is picked from the size of the shorter
+   * operand, very unbalanced operands are cut into balanced pieces first.
+   * Squares, a and b being the same limbs, go to sqr_limbs.
+   */
+  static void mul_limbs(limb *r, const limb *a, size_t an, const limb *b,
+                        size_t bn) {
+    if (a == b && an == bn)
+      sqr_limbs(r, a, an);
+    else if (bn < karatsuba_threshold || bn < 2)
+      mul_basecase(r, a, an, b, bn);
+    else if (2 * bn <= an + 1)
+      mul_unbalanced(r, a, an, b, bn);
+    else if (bn < toom3_threshold || bn < 3)
+      mul_karatsuba(r, a, an, b, bn);
+    else if (bn < ntt_threshold)
+      mul_toom3(r, a, an, b, bn);
+    else
+      mul_ntt(r, a, an, b, bn);
+  }
+
+  /**
+   * @brief r = a * b for an much larger than bn, done as a sequence of
+   * bn x bn products.
+   */
+  static void mul_unbalanced(limb *r, const limb *a, size_t an, const limb *b,
+                             size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    scratch_vector tmp(2 * bn, scratch_resource());
+    for (size_t i = 0; i < an; i += bn) {
+      size_t len = std::min(bn, an - i);
+      if (len == bn)
+        mul_limbs(tmp.data(), a + i, len, b, bn);
+      else
+        mul_limbs(tmp.data(), b, bn, a + i, len);
+      limb c = add_n(r + i, r + i, tmp.data(), len + bn);
+      add_1(r + i + len + bn, r + i + len + bn, an - i - len, c);
+    }
+  }
+
+  /**
+   * @brief Karatsuba multiplication, r = a * b for roughly balanced operands.
+   *
+   * With a = a1 * B^h + a0 and b = b1 * B^h + b0, it needs a0 * b0, a1 * b1
+   * and (a0 - a1) * (b0 - b1), the subtractive form avoiding an extra carry
+   * limb in the middle product.
+   */
+  static void mul_karatsuba(limb *r, const limb *a, size_t an, const limb *b,
+                            size_t bn) {
+    BIGINT_STATS_SCOPE(thread_stats.mul_karatsuba, an + bn);
+    size_t h = (an + 1) / 2; // bn > h, as mul_limbs guarantees
+    size_t n = an + bn;
+    scratch_vector tmp(6 * h + 1, scratch_resource());
+    limb *da = tmp.data();
+    limb *db = da + h;
+    limb *zm = db + h;
+    limb *t = zm + 2 * h;
+
+    bool sa = abs_diff(da, a, h, a + h, an - h);
+    bool sb = abs_diff(db, b, h, b + h, bn - h);
+    parallel_for(3, bn - h, [&](size_t i) {
+      if (i == 0)
+        mul_limbs(zm, da, h, db, h);
+      else if (i == 1)
+        mul_limbs(r, a, h, b, h);
+      else
+        mul_limbs(r + 2 * h, a + h, an - h, b + h, bn - h);
+    });
+
+    // t = a0 * b0 + a1 * b1, then the middle term is t -+ zm.
+    limb c = add_n(t, r, r + 2 * h, n - 2 * h);
+    t[2 * h] = add_1(t + n - 2 * h, r + n - 2 * h, 4 * h - n, c);
+    if (sa == sb)
+      t[2 * h] -= sub_n(t, t, zm, 2 * h);
+    else
+      t[2 * h] += add_n(t, t, zm, 2 * h);
+
+    size_t len = std::min(2 * h + 1, n - h);
+    c = add_n(r + h, r + h, t, len);
+    add_1(r + h + len, r + h + len, n - h - len, c);
+  }
+
+  /**
+   * @brief Squaring dispatch, r = a * a.
+   *
+   * r must have room for 2 * n limbs and must not overlap a. Uses the same
+   * cutoffs as mul_limbs.
+   */
+  static void sqr_limbs(limb *r, const limb *a, size_t n) {
+    if (n < karatsuba_threshold || n < 2)
+      sqr_basecase(r, a, n);
+    else if (n < toom3_threshold || n < 3)
+      sqr_karatsuba(r, a, n);
+    else if (n < ntt_threshold)
+      sqr_toom3(r, a, n);
+    else
+      mul_ntt(r, a, n, a, n);
+  }
+
+  /**
+   * @brief Schoolbook squaring, r = a * a.
+   *
+   * Each cross product a[i] * a[j] with i < j is formed once and the sum is
+   * doubled, before the squares a[i]^2 are added on the diagonal. That is
+   * about half the limb products of mul_basecase.
+   */
+  static void sqr_basecase(limb *r, const limb *a, size_t n) {
+    BIGINT_STATS_SCOPE(thread_stats.sqr_schoolbook, n);
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; i++)
+      r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    lshift(r, r, 2 * n, 1);
+
+    limb c = 0;
+    for (size_t i = 0; i < n; i++) {
+      dlimb sq = static_cast<dlimb>(a[i]) * a[i];
+      dlimb t = static_cast<dlimb>(r[2 * i]) + static_cast<limb>(sq) + c;
+      r[2 * i] = static_cast<limb>(t);
+      t = static_cast<dlimb>(r[2 * i + 1]) + static_cast<limb>(sq >> 64) +
+          static_cast<limb>(t >> 64);
+      r[2 * i + 1] = static_cast<limb>(t);
+      c = static_cast<limb>(t >> 64);
+    }
+  }
+
+  /**
+   * @brief Karatsuba squaring, r = a * a.
+   *
+   * With a = a1 * B^h + a0 the middle term is a0^2 + a1^2 - (a0 - a1)^2, so
+   * all three sub-products are squares again.
+   */
+  static void sqr_karatsuba(limb *r, const limb *a, size_t n) {
+    BIGINT_STATS_SCOPE(thread_stats.sqr_karatsuba, n);
+    size_t h = (n + 1) / 2;
+    scratch_vector tmp(5 * h + 1, scratch_resource());
+    limb *d = tmp.data();
+    limb *zm = d + h;
+    limb *t = zm + 2 * h;
+
+    abs_diff(d, a, h, a + h, n - h);
+    parallel_for(3, n - h, [&](size_t i) {
+      if (i == 0)
+        sqr_limbs(zm, d, h);
+      else if (i == 1)
+        sqr_limbs(r, a, h);
+      else
+        sqr_limbs(r + 2 * h, a + h, n - h);
+    });
+
+    limb c = add_n(t, r, r + 2 * h, 2 * (n - h));
+    t[2 * h] = add_1(t + 2 * (n - h), r + 2 * (n - h), 2 * h - 2 * (n - h), c);
+    t[2 * h] -= sub_n(t, t, zm, 2 * h);
+
+    size_t len = std::min(2 * h + 1, 2 * n - h);
+    c = add_n(r + h, r + h, t, len);
+    add_1(r + h + len, r + h + len, 2 * n - h - len, c);
+  }
+
+  /**
+   * @brief Toom-3 multiplication, r = a * b for roughly balanced operands.
+   *
+   * Both operands are cut into three pieces of k limbs, which are evaluated
+   * at 0, 1, -1, -2 and infinity. The five point products are interpolated
+   * back with Bodrato's sequence. Evaluation and interpolation need signed
+   * values, so they are done on bigints.
+   */
+  static void mul_toom3(limb *r, const limb *a, size_t an, const limb *b,
+                        size_t bn) {
+    BIGINT_STATS_SCOPE(thread_stats.mul_toom3, an + bn);
+    size_t k = (an + 2) / 3;
+    bigint va[5], vb[5], w[5];
+    toom3_eval(toom3_piece(a, an, k, 0), toom3_piece(a, an, k, 1),
+               toom3_piece(a, an, k, 2), va);
+    toom3_eval(toom3_piece(b, bn, k, 0), toom3_piece(b, bn, k, 1),
+               toom3_piece(b, bn, k, 2), vb);
+    parallel_for(5, k, [&](size_t i) { w[i] = va[i] * vb[i]; });
+    toom3_interpolate(r, an + bn, k, w);
+  }
+
+  /**
+   * @brief Toom-3 squaring, r = a * a, with five point squares instead of
+   * products.
+   */
+  static void sqr_toom3(limb *r, const limb *a, size_t n) {
+    BIGINT_STATS_SCOPE(thread_stats.sqr_toom3, n);
+    size_t k = (n + 2) / 3;
+    bigint va[5], w[5];
+    toom3_eval(toom3_piece(a, n, k, 0), toom3_piece(a, n, k, 1),
+               toom3_piece(a, n, k, 2), va);
+    parallel_for(5, k, [&](size_t i) { w[i] = va[i].square(); });
+    toom3_interpolate(r, 2 * n, k, w);
+  }
+
+  /**
+   * @brief Piece i of k limbs of the n-limb a, clamped to its size.
+   */
+  static bigint toom3_piece(const limb *a, size_t n, size_t k, size_t i) {
+    size_t lo = std::min(n, i * k);
+    return from_limbs(a + lo, std::min(n, lo + k) - lo);
+  }
+
+  /**
+   * @brief Evaluates m0 + m1 x + m2 x^2 at 0, 1, -1, -2 and infinity.
+   */
+  static void toom3_eval(const bigint &m0, const bigint &m1, const bigint &m2,
+                         bigint *v) {
+    bigint p = m0 + m2;
+    v[0] = m0;
+    v[1] = p + m1;
+    v[2] = p - m1;
+    v[3] = v[2] + m2;
+    v[3] = v[3] + v[3] - m0;
+    v[4] = m2;
+  }
+
+  /**
+   * @brief Recovers the five coefficients from the point values w at 0, 1,
+   * -1, -2 and infinity, which it consumes, and sums them into the n limbs
+   * of r at multiples of k limbs.
+   */
+  static void toom3_interpolate(limb *r, size_t n, size_t k, bigint *w) {
+    bigint &w0 = w[0], &w1 = w[1], &wm1 = w[2], &wm2 = w[3], &winf = w[4];
+    bigint r3 = wm2 - w1;
+    r3.div_exact_1(3);
+    bigint r1 = w1 - wm1;
+    r1.div_exact_1(2);
+    bigint r2 = wm1 - w0;
+    r3 = r2 - r3;
+    r3.div_exact_1(2);
+    r3 = r3 + winf + winf;
+    r2 = r2 + r1 - winf;
+    r1 = r1 - r3;
+
+    // All coefficients are non-negative now, so they can be summed as
+    // magnitudes.
+    std::fill(r, r + n, 0);
+    const bigint *coef[5] = {&w0, &r1, &r2, &r3, &winf};
+    for (size_t i = 0; i < 5; i++) {
+      const limb_vector &l = coef[i]->limbs;
+      if (l.empty())
+        continue;
+      limb *dst = r + i * k;
+      limb c = add_n(dst, dst, l.data(), l.size());
+      add_1(dst + l.size(), dst + l.size(), n - i * k - l.size(), c);
+    }
+  }
+
+  /**
+   * @brief A prime p = c * 2^k + 1 below 2^62 used by the number theoretic
+   * transform, with its Montgomery constants for R = 2^64.
+   *
+   * Values kept in Montgomery form are x * R mod p. Multiplying a value in
+   * Montgomery form by one in plain form gives a plain result, which is
+   * used to fold conversions into other multiplications.
+   */
+  struct ntt_prime {
+    limb p;
+    limb g;    // Primitive root
+    limb pinv; // -p^-1 mod R
+    limb r2;   // R^2 mod p
+
+    constexpr ntt_prime(limb p, limb g) : p(p), g(g), pinv(0), r2(0) {
+      limb x = p; // Newton iteration, each step doubles the correct bits
+      for (int i = 0; i < 5; i++)
+        x *= 2 - p * x;
+      pinv = 0 - x;
+      limb r = (0 - p) % p;
+      r2 = static_cast<limb>(static_cast<dlimb>(r) * r % p);
+    }
+
+    limb reduce(dlimb t) const {
+      limb m = static_cast<limb>(t) * pinv;
+      limb r = static_cast<limb>((t + static_cast<dlimb>(m) * p) >> 64);
+      return r >= p ? r - p : r;
+    }
+    limb mul(limb a, limb b) const {
+      return reduce(static_cast<dlimb>(a) * b);
+    }
+    limb add(limb a, limb b) const {
+      limb s = a + b;
+      return s >= p ? s - p : s;
+    }
+    limb sub(limb a, limb b) const { return a >= b ? a - b : a - b + p; }
+    // Any limb is below R, so a * r2 < p * R is a valid input to reduce().
+    limb to_mont(limb a) const { return mul(a, r2); }
+    limb pow(limb a, uint64_t e) const {
+      limb result = to_mont(1);
+      for (; e > 0; e >>= 1, a = mul(a, a)) {
+        if (e & 1)
+          result = mul(result, a);
+      }
+      return result;
+    }
+  };
+
+  /**
+   * @brief The three transform primes. Their product is about 2^186, which
+   * bounds a convolution coefficient of up to 2^57 limb products exactly.
+   */
+  static const ntt_prime &ntt_modulus(size_t i) {
+    static constexpr ntt_prime primes[3] = {
+        ntt_prime(0x3fffc00000000001ull, 11),
+        ntt_prime(0x3fffbe0000000001ull, 3),
+        ntt_prime(0x3fff840000000001ull, 19),
+    };
+    return primes[i];
+  }
+
+  /**
+   * @brief Twiddle factors for transforms of length n, in Montgomery form.
+   *
+   * Entry len + j holds w^j for the primitive 2 * len-th root of unity w, so
+   * that every butterfly level reads a contiguous range.
+   */
+  static scratch_vector ntt_roots(const ntt_prime &m, size_t n,
+                                     bool inverse) {
+    scratch_vector roots(std::max<size_t>(n, 2), scratch_resource());
+    limb w = m.pow(m.to_mont(m.g), (m.p - 1) / n);
+    if (inverse)
+      w = m.pow(w, n - 1);
+    size_t half = n / 2;
+    roots[half] = m.to_mont(1);
+    for (size_t j = 1; j < half; j++)
+      roots[half + j] = m.mul(roots[half + j - 1], w);
+    for (size_t len = half / 2; len > 0; len /= 2) {
+      for (size_t j = 0; j < len; j++)
+        roots[len + j] = roots[2 * len + 2 * j];
+    }
+    return roots;
+  }
+
+  /**
+   * @brief Forward transform, decimation in frequency. The output is in
+   * bit-reversed order, which the pointwise product does not mind.
+   */
+  static void ntt_forward(const ntt_prime &m, limb *a, size_t n,
+                          const limb *roots) {
+    for (size_t len = n / 2; len > 0; len /= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        for (size_t j = 0; j < len; j++) {
+          limb u = a[i + j];
+          limb v = a[i + j + len];
+          a[i + j] = m.add(u, v);
+          a[i + j + len] = m.mul(m.sub(u, v), roots[len + j]);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Inverse transform, decimation in time, taking bit-reversed input
+   * back to natural order. The 1/n scaling is left to the caller.
+   */
+  static void ntt_inverse(const ntt_prime &m, limb *a, size_t n,
+                          const limb *roots) {
+    for (size_t len = 1; len < n; len *= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        for (size_t j = 0; j < len; j++) {
+          limb u = a[i + j];
+          limb v = m.mul(a[i + j + len], roots[len + j]);
+          a[i + j] = m.add(u, v);
+          a[i + j + len] = m.sub(u, v);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Number theoretic transform multiplication, r = a * b.
+   *
+   * The limbs are used directly as coefficients. The cyclic convolution is
+   * computed modulo each of the three primes and the exact coefficients are
+   * recovered with Garner's CRT, then the carries are propagated. Squaring
+   * (a and b being the same limbs) needs only one forward transform per
+   * prime.
+   */
+  static void mul_ntt(limb *r, const limb *a, size_t an, const limb *b,
+                      size_t bn) {
+    bool square = a == b && an == bn;
+    BIGINT_STATS_SCOPE(square ? thread_stats.sqr_ntt : thread_stats.mul_ntt,
+                       square ? an : an + bn);
+    size_t n = 1;
+    while (n < an + bn - 1)
+      n *= 2;
+
+    scratch_vector res(3 * n, scratch_resource());
+    // The primes are independent, each one works on its own third of res.
+    parallel_for(3, bn, [&](size_t k) {
+      const ntt_prime &m = ntt_modulus(k);
+      scratch_vector tmp(square ? 0 : n, scratch_resource());
+      limb *fa = res.data() + k * n;
+      for (size_t i = 0; i < an; i++)
+        fa[i] = m.to_mont(a[i]);
+      scratch_vector roots = ntt_roots(m, n, false);
+      ntt_forward(m, fa, n, roots.data());
+
+      if (square) {
+        for (size_t i = 0; i < n; i++)
+          fa[i] = m.mul(fa[i], fa[i]);
+      } else {
+        for (size_t i = 0; i < bn; i++)
+          tmp[i] = m.to_mont(b[i]);
+        ntt_forward(m, tmp.data(), n, roots.data());
+        for (size_t i = 0; i < n; i++)
+          fa[i] = m.mul(fa[i], tmp[i]);
+      }
+
+      roots = ntt_roots(m, n, true);
+      ntt_inverse(m, fa, n, roots.data());
+      // Montgomery form times the plain 1/n leaves plain residues.
+      limb n_inv = m.p - (m.p - 1) / n;
+      for (size_t i = 0; i < n; i++)
+        fa[i] = m.mul(fa[i], n_inv);
+    });
+
+    // Garner: x = x1 + t2 * p1 + t3 * p1 * p2, where the constants below are
+    // in Montgomery form so that multiplying by them gives plain values.
+    const ntt_prime &m1 = ntt_modulus(0);
+    const ntt_prime &m2 = ntt_modulus(1);
+    const ntt_prime &m3 = ntt_modulus(2);
+    limb p1_inv_2 = m2.pow(m2.to_mont(m1.p), m2.p - 2);
+    limb p1_3 = m3.to_mont(m1.p);
+    limb p12_inv_3 = m3.pow(m3.mul(p1_3, m3.to_mont(m2.p)), m3.p - 2);
+    dlimb p12 = static_cast<dlimb>(m1.p) * m2.p;
+    limb p12_lo = static_cast<limb>(p12);
+    limb p12_hi = static_cast<limb>(p12 >> 64);
+
+    size_t rn = an + bn;
+    limb k0 = 0, k1 = 0; // Carry into the current limb, two limbs wide
+    for (size_t i = 0; i < rn; i++) {
+      limb x1 = 0, x2 = 0, x3 = 0;
+      if (i < an + bn - 1) {
+        x1 = res[i];
+        x2 = res[n + i];
+        x3 = res[2 * n + i];
+      }
+      limb t2 = m2.mul(m2.sub(x2, x1 % m2.p), p1_inv_2);
+      limb u = m3.sub(m3.sub(x3, x1 % m3.p), m3.mul(t2 % m3.p, p1_3));
+      limb t3 = m3.mul(u, p12_inv_3);
+
+      dlimb v = static_cast<dlimb>(t2) * m1.p + x1;
+      dlimb lo = static_cast<dlimb>(t3) * p12_lo;
+      dlimb hi = static_cast<dlimb>(t3) * p12_hi;
+      limb s0 = static_cast<limb>(v) + static_cast<limb>(lo);
+      dlimb s1 = (v >> 64) + (lo >> 64) + static_cast<limb>(hi) +
+                 (s0 < static_cast<limb>(v));
+      limb s2 = static_cast<limb>(hi >> 64) + static_cast<limb>(s1 >> 64);
+
+      // Add the carry in and emit the low limb.
+      r[i] = s0 + k0;
+      dlimb c = static_cast<dlimb>(static_cast<limb>(s1)) + k1 + (r[i] < k0);
+      k0 = static_cast<limb>(c);
+      k1 = s2 + static_cast<limb>(c >> 64);
+    }
+  }
+
+  /**
+   * @brief Sliding window exponentiation in the residue domain of ctx.
+   *
+   * base and the result are ctx.n limbs in the representation of the
+   * context. The table of odd powers and the scratch space are allocated
+   * before the loop, which then only calls ctx.mul and ctx.sqr in place.
+   */
+  template <class Context>
+  static limb_vector window_pow(const Context &ctx, const limb *base,
+                                const bigint &exp) {
+    size_t n = ctx.n;
+    limb_vector result;
+    result.assign(ctx.one.data(), ctx.one.data() + n);
+    size_t bits = exp.bit_length_abs();
+    if (bits == 0)
+      return result;
+
+    size_t w = bits > 671  ? 6
+               : bits > 239 ? 5
+               : bits > 79  ? 4
+               : bits > 23  ? 3
+               : bits > 6   ? 2
+                            : 1;
+    // table[i] = base^(2i + 1) for i < 2^(w - 1).
+    size_t entries = size_t(1) << (w - 1);
+    limb_vector table, sq, scratch;
+    table.resize(entries * n);
+    sq.resize(n);
+    scratch.resize(ctx.scratch_size());
+    limb *t = table.data();
+    limb *acc = result.data();
+    limb *s = scratch.data();
+    std::copy(base, base + n, t);
+    if (entries > 1) {
+      ctx.sqr(sq.data(), base, s);
+      for (size_t i = 1; i < entries; i++)
+        ctx.mul(t + i * n, t + (i - 1) * n, sq.data(), s);
+    }
+
+    auto bit = [&](size_t i) { return (exp.limbs[i / 64] >> (i % 64)) & 1; };
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+      if (!bit(i - 1)) {
+        if (started)
+          ctx.sqr(acc, acc, s);
+        i--;
+        continue;
+      }
+      // The window is bits [j, i), with its lowest bit set.
+      size_t j = i > w ? i - w : 0;
+      while (!bit(j))
+        j++;
+      limb value = 0;
+      for (size_t k = i; k-- > j;)
+        value = value << 1 | bit(k);
+      const limb *entry = t + (value >> 1) * n;
+      if (started) {
+        for (size_t k = j; k < i; k++)
+          ctx.sqr(acc, acc, s);
+        ctx.mul(acc, acc, entry, s);
+      } else {
+        std::copy(entry, entry + n, acc);
+        started = true;
+      }
+      i = j;
+    }
+    return result;
+  }
+};
+
+/**
+ * @class bigint::montgomery_context
+ * @brief Precomputed constants for Montgomery arithmetic modulo a fixed odd
+ * modulus.
+ *
+ * A residue x is held in Montgomery form as x * R mod m, with R = 2^(64 n)
+ * for an n limb modulus, so that a product is reduced by n multiply-adds
+ * instead of a division. Products are schoolbook on fixed n limb buffers,
+ * and pow_mod allocates all of them before its loop.
+ */
+class bigint::montgomery_context {
+public:
+  /**
+   * @brief Precomputes the constants for the given modulus.
+   * @param modulus The modulus, whose absolute value is used.
+   * @throw std::invalid_argument if |modulus| is even or one.
+   */
+  explicit montgomery_context(const bigint &modulus) : m(modulus) {
+    m.ne = false;
+    n = m.limbs.size();
+    if (n == 0 || !(m.limbs[0] & 1) || (n == 1 && m.limbs[0] == 1))
+      throw std::invalid_argument(
+          "Montgomery modulus must be odd and greater than one");
+
+    // Newton's iteration for m^-1 mod 2^64. An odd limb is its own inverse
+    // mod 2^3, and every step doubles the number of correct bits.
+    limb inv = m.limbs[0];
+    for (int i = 0; i < 5; i++)
+      inv *= 2 - m.limbs[0] * inv;
+    minv = 0 - inv;
+
+    bigint r = 1;
+    r.shl_abs(64 * n);
+    one = load(r);
+    r.shl_abs(64 * n);
+    r2 = load(r);
+  };
+
+  /**
+   * @brief The modulus, made non-negative.
+   */
+  const bigint &modulus() const { return m; };
+
+  /**
+   * @brief Converts a value to Montgomery form.
+   * @param x The value, reduced modulo the modulus first.
+   * @return x * R mod m.
+   */
+  bigint to_montgomery(const bigint &x) const {
+    limb_vector a = load(x), scratch;
+    scratch.resize(scratch_size());
+    mul(a.data(), a.data(), r2.data(), scratch.data());
+    return result(a);
+  };
+
+  /**
+   * @brief Converts a value back from Montgomery form.
+   * @param x The value in Montgomery form.
+   * @return x / R mod m.
+   */
+  bigint from_montgomery(const bigint &x) const {
+    limb_vector a = load(x), t;
+    t.resize(scratch_size());
+    std::copy(a.begin(), a.end(), t.begin());
+    redc(a.data(), t.data());
+    return result(a);
+  };
+
+  /**
+   * @brief Montgomery product of two values in Montgomery form.
+   * @return a * b / R mod m, the Montgomery form of the product.
+   */
+  bigint mul_mod(const bigint &a, const bigint &b) const {
+    limb_vector x = load(a), y = load(b), scratch;
+    scratch.resize(scratch_size());
+    mul(x.data(), x.data(), y.data(), scratch.data());
+    return result(x);
+  };
+
+  /**
+   * @brief Montgomery square of a value in Montgomery form.
+   * @return a * a / R mod m, the Montgomery form of the square.
+   */
+  bigint sqr_mod(const bigint &a) const {
+    limb_vector x = load(a), scratch;
+    scratch.resize(scratch_size());
+    sqr(x.data(), x.data(), scratch.data());
+    return result(x);
+  };
+
+  /**
+   * @brief Modular exponentiation by a sliding window.
+   * @param base The base, an ordinary value rather than a Montgomery form.
+   * @param exp The exponent, which must not be negative.
+   * @return base^exp mod m, in [0, m).
+   * @throw std::domain_error if exp is negative.
+   */
+  bigint pow_mod(const bigint &base, const bigint &exp) const {
+    if (exp.ne)
+      throw std::domain_error("Negative exponent");
+    bigint b = to_montgomery(base);
+    limb_vector x = load(b);
+    limb_vector r = window_pow(*this, x.data(), exp);
+    limb_vector t;
+    t.resize(scratch_size());
+    std::copy(r.begin(), r.end(), t.begin());
+    redc(r.data(), t.data());
+    return result(r);
+  };
+
+private:
+  friend class bigint;
+
+  bigint m;
+  size_t n;
+  limb minv;
+  /**
+   * @brief R mod m, the Montgomery form of one, and R^2 mod m.
+   */
+  limb_vector one, r2;
+
+  /**
+   * @brief x mod m as exactly n limbs.
+   */
+  limb_vector load(const bigint &x) const {
+    bigint y = x;
+    if (y.ne || !y.abs_less(m)) {
+      y = y % m;
+      if (y.ne)
+        y += m;
+    }
+    limb_vector v;
+    v.resize(n);
+    std::copy(y.limbs.begin(), y.limbs.end(), v.begin());
+    return v;
+  };
+
+  /**
+   * @brief The bigint holding the n limbs a.
+   */
+  static bigint result(const limb_vector &a) {
+    return from_limbs(a.data(), a.size());
+  };
+
+  size_t scratch_size() const { return 2 * n; };
+
+  /**
+   * @brief Montgomery reduction, r = t / R mod m for t < m * R.
+   *
+   * t holds 2n limbs and is destroyed. Each step adds the multiple of m
+   * that clears the lowest remaining limb, leaving a value below 2m in the
+   * top half, and one conditional subtraction finishes.
+   */
+  void redc(limb *r, limb *t) const {
+    const limb *p = m.limbs.data();
+    limb top = 0;
+    for (size_t i = 0; i < n; i++) {
+      limb c = addmul_1(t + i, p, n, t[i] * minv);
+      dlimb s = static_cast<dlimb>(t[i + n]) + c + top;
+      t[i + n] = static_cast<limb>(s);
+      top = static_cast<limb>(s >> 64);
+    }
+    if (top != 0 || cmp_n(t + n, p, n) >= 0)
+      sub_n(r, t + n, p, n);
+    else
+      std::copy(t + n, t + 2 * n, r);
+  };
+
+  /**
+   * @brief r = a * b / R mod m on n limb residues. r may alias a or b.
+   */
+  void mul(limb *r, const limb *a, const limb *b, limb *scratch) const {
+    mul_basecase(scratch, a, n, b, n);
+    redc(r, scratch);
+  };
+
+  /**
+   * @brief r = a * a / R mod m on n limb residues. r may alias a.
+   */
+  void sqr(limb *r, const limb *a, limb *scratch) const {
+    sqr_basecase(scratch, a, n);
+    redc(r, scratch);
+  };
+};
+
+/**
+ * @class bigint::barrett_context
+ * @brief Precomputed reciprocal for Barrett reduction modulo a fixed
+ * modulus.
+ *
+ * Unlike montgomery_context, the modulus may be even and values stay in
+ * their ordinary form. A product below m^2 is reduced with two multiplies
+ * by the precomputed mu = floor((B^(2n) - 1) / m) and a few subtractions.
+ */
+class bigint::barrett_context {
+public:
+  /**
+   * @brief Precomputes the reciprocal of the given modulus.
+   * @param modulus The modulus, whose absolute value is used.
+   * @throw std::invalid_argument if |modulus| is zero or one.
+   */
+  explicit barrett_context(const bigint &modulus) : m(modulus) {
+    m.ne = false;
+    n = m.limbs.size();
+    if (n == 0 || (n == 1 && m.limbs[0] == 1))
+      throw std::invalid_argument("Barrett modulus must be greater than one");
+
+    // B^(2n) - 1 rather than B^(2n) keeps mu within n + 1 limbs when m is
+    // a power of B, at the cost of at most one more final subtraction.
+    bigint b = 1;
+    b.shl_abs(128 * n);
+    bigint q = --b / m;
+    mu.resize(n + 1);
+    std::copy(q.limbs.begin(), q.limbs.end(), mu.begin());
+    one.resize(n);
+    one[0] = 1;
+  };
+
+  /**
+   * @brief The modulus, made non-negative.
+   */
+  const bigint &modulus() const { return m; };
+
+  /**
+   * @brief Modular multiplication.
+   * @return a * b mod m, in [0, m).
+   */
+  bigint mul_mod(const bigint &a, const bigint &b) const {
+    limb_vector x = load(a), y = load(b), scratch;
+    scratch.resize(scratch_size());
+    mul(x.data(), x.data(), y.data(), scratch.data());
+    return from_limbs(x.data(), n);
+  };
+
+  /**
+   * @brief Modular squaring.
+   * @return a * a mod m, in [0, m).
+   */
+  bigint sqr_mod(const bigint &a) const {
+    limb_vector x = load(a), scratch;
+    scratch.resize(scratch_size());
+    sqr(x.data(), x.data(), scratch.data());
+    return from_limbs(x.data(), n);
+  };
+
+  /**
+   * @brief Modular exponentiation by a sliding window.
+   * @param base The base.
+   * @param exp The exponent, which must not be negative.
+   * @return base^exp mod m, in [0, m).
+   * @throw std::domain_error if exp is negative.
+   */
+  bigint pow_mod(const bigint &base, const bigint &exp) const {
+    if (exp.ne)
+      throw std::domain_error("Negative exponent");
+    limb_vector x = load(base);
+    limb_vector r = window_pow(*this, x.data(), exp);
+    return from_limbs(r.data(), n);
+  };
+
+private:
+  friend class bigint;
+
+  bigint m;
+  size_t n;
+  /**
+   * @brief floor((B^(2n) - 1) / m) as n + 1 limbs, and one as n limbs.
+   */
+  limb_vector mu, one;
+
+  /**
+   * @brief x mod m as exactly n limbs.
+   */
+  limb_vector load(const bigint &x) const {
+    bigint y = x;
+    if (y.ne || !y.abs_less(m)) {
+      y = y % m;
+      if (y.ne)
+        y += m;
+    }
+    limb_vector v;
+    v.resize(n);
+    std::copy(y.limbs.begin(), y.limbs.end(), v.begin());
+    return v;
+  };
+
+  /**
+   * @brief 2n limbs for the product, then room for reduce.
+   */
+  size_t scratch_size() const { return 6 * n + 3; };
+
+  /**
+   * @brief Barrett reduction, r = x mod m for x < B^(2n).
+   *
+   * The quotient estimate floor(floor(x / B^(n-1)) * mu / B^(n+1)) is at
+   * most three below the true quotient, so the remainder is below 4m and is
+   * computed modulo B^(n+1), where it fits.
+   */
+  void reduce(limb *r, const limb *x, limb *scratch) const {
+    const limb *p = m.limbs.data();
+    limb *q = scratch;
+    limb *qm = scratch + 2 * n + 2;
+    mul_basecase(q, x + n - 1, n + 1, mu.data(), n + 1);
+    mul_basecase(qm, q + n + 1, n + 1, p, n);
+    sub_n(qm, x, qm, n + 1);
+    while (qm[n] != 0 || cmp_n(qm, p, n) >= 0)
+      qm[n] -= sub_n(qm, qm, p, n);
+    std::copy(qm, qm + n, r);
+  };
+
+  /**
+   * @brief r = a * b mod m on n limb residues. r may alias a or b.
+   */
+  void mul(limb *r, const limb *a, const limb *b, limb *scratch) const {
+    mul_basecase(scratch, a, n, b, n);
+    reduce(r, scratch, scratch + 2 * n);
+  };
+
+  /**
+   * @brief r = a * a mod m on n limb residues. r may alias a.
+   */
+  void sqr(limb *r, const limb *a, limb *scratch) const {
+    sqr_basecase(scratch, a, n);
+    reduce(r, scratch, scratch + 2 * n);
+  };
+};
+
+/**
+ * @class bigint_view
+ * @brief Read-only bigint stored elsewhere in the binary record format, for
+ * example in a memory mapped checkpoint file.
+ *
+ * The view points at the limbs of the record where they are, nothing is
+ * copied or converted, so the memory must outlive it. Since the limbs are
+ * used in place, the record must start on an 8-byte boundary, which holds
+ * for records written back to back at the start of a mapping, and the host
+ * must be little endian.
+ */
+class bigint_view {
+public:
+  /**
+   * @brief A view of zero.
+   */
+  bigint_view() = default;
+
+  /**
+   * @brief Views the record at data.
+   * @param data The start of the record, 8-byte aligned.
+   * @param size The bytes available at data, at least the record's size.
+   * Records that follow the first one are ignored, record_size() tells
+   * where the next one starts.
+   * @throw std::invalid_argument if the record is truncated, malformed or
+   * not aligned, or the host is not little endian.
+   */
+  bigint_view(const void *data, size_t size) {
+    if (!bigint::little_endian)
+      throw std::invalid_argument("bigint_view needs a little endian host");
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0)
+      throw std::invalid_argument("Misaligned bigint record");
+    n = bigint::record_limbs(data, size, ne);
+    p = static_cast<const uint64_t *>(data) + 1;
+    bigint::check_record(p, n, ne);
+  };
+
+  /**
+   * @brief Size of the viewed record.
+   * @return 8 * (limb count + 1) bytes.
+   */
+  size_t record_size() const { return (n + 1) * sizeof(uint64_t); };
+
+  /**
+   * @brief Number of limbs of the magnitude, 0 for zero.
+   */
+  size_t size() const { return n; };
+
+  /**
+   * @brief The limbs of the magnitude, least significant first.
+   */
+  const uint64_t *data() const { return p; };
+
+  /**
+   * @brief Whether the value is negative.
+   */
+  bool negative() const { return ne; };
+
+  /**
+   * @brief Three-way comparison with a bigint.
+   * @param rhs The bigint to compare with.
+   * @return Negative, zero or positive as the view is less than, equal to
+   * or greater than rhs.
+   */
+  int compare(const bigint &rhs) const {
+    if (ne != rhs.ne)
+      return ne ? -1 : 1;
+    int c = n != rhs.limbs.size() ? (n < rhs.limbs.size() ? -1 : 1)
+                                  : bigint::cmp_n(p, rhs.limbs.data(), n);
+    return ne ? -c : c;
+  };
+
+  /**
+   * @brief Equality with a bigint.
+   */
+  bool operator==(const bigint &rhs) const { return compare(rhs) == 0; };
+  bool operator!=(const bigint &rhs) const { return compare(rhs) != 0; };
+
+  /**
+   * @brief Converts to a decimal string, see bigint::to_string().
+   */
+  std::string to_string() const { return bigint(*this).to_string(); };
+
+  /**
+   * @brief Writes the decimal value to a stream.
+   * @param stream The stream to write to.
+   * @param view The view to write.
+   * @return The stream.
+   */
+  friend std::ostream &operator<<(std::ostream &stream,
+                                  const bigint_view &view) {
+    return stream << view.to_string();
+  };
+
+private:
+  const uint64_t *p = nullptr;
+  size_t n = 0;
+  bool ne = false;
+
+  friend class bigint;
+};
+
+inline bigint::bigint(const bigint_view &view) : ne(view.ne) {
+  limbs.assign(view.p, view.p + view.n);
+}
+
+inline bigint &bigint::operator+=(const bigint_view &rhs) {
+  BIGINT_STATS_SCOPE(thread_stats.add, limbs.size() + rhs.n);
+  if (ne == rhs.ne)
+    add_abs(rhs.p, rhs.n);
+  else
+    sub_abs(rhs.p, rhs.n);
+  return *this;
+}
+
+inline bigint &bigint::operator-=(const bigint_view &rhs) {
+  BIGINT_STATS_SCOPE(thread_stats.sub, limbs.size() + rhs.n);
+  if (ne == rhs.ne)
+    sub_abs(rhs.p, rhs.n);
+  else
+    add_abs(rhs.p, rhs.n);
+  return *this;
+}
+
+inline bigint pow_mod(const bigint &base, const bigint &exp,
+                      const bigint &mod) {
+  if (mod.limbs.empty())
+    throw std::domain_error("Division by zero");
+  if (exp.ne)
+    throw std::domain_error("Negative exponent");
+  if (mod.limbs.size() == 1 && mod.limbs[0] == 1)
+    return bigint();
+  if (mod.limbs[0] & 1)
+    return bigint::montgomery_context(mod).pow_mod(base, exp);
+  return bigint::barrett_context(mod).pow_mod(base, exp);
+}
+
+/**
+ * The product of the quotient steps [[q, 1], [1, 0]] of a run of Euclid's
+ * algorithm, so that (a, b) = M (a', b') for the remainders a', b' it leads
+ * to. The entries are non-negative, and the determinant is -1 if odd is set
+ * and 1 otherwise.
+ */
+struct bigint::gcd_matrix {
+  bigint m00 = 1, m01, m10, m11 = 1;
+  bool odd = false;
+  bigint t0, t1; // Scratch of append_1
+
+  /**
+   * @brief Whether no step has been taken.
+   */
+  bool identity() const { return m01.limbs.empty(); }
+
+  /**
+   * @brief Appends the step of quotient q, M = M [[q, 1], [1, 0]].
+   */
+  void step(const bigint &q) {
+    bigint t = m00 * q + m01;
+    m01 = std::exchange(m00, std::move(t));
+    t = m10 * q + m11;
+    m11 = std::exchange(m10, std::move(t));
+    odd = !odd;
+  }
+
+  /**
+   * @brief Appends the steps of n, M = M N.
+   */
+  void append(const gcd_matrix &n) {
+    bigint a = m00 * n.m00 + m01 * n.m10;
+    bigint b = m00 * n.m01 + m01 * n.m11;
+    bigint c = m10 * n.m00 + m11 * n.m10;
+    m11 = m10 * n.m01 + m11 * n.m11;
+    m00 = std::move(a);
+    m01 = std::move(b);
+    m10 = std::move(c);
+    odd = odd != n.odd;
+  }
+
+  /**
+   * @brief Appends the steps of a matrix of limbs, M = M W.
+   */
+  void append_1(limb w00, limb w01, limb w10, limb w11, bool w_odd) {
+    t0.assign_mul_add_1(m00, w00, m01, w10);
+    t1.assign_mul_add_1(m00, w01, m01, w11);
+    std::swap(m00.limbs, t0.limbs);
+    std::swap(m01.limbs, t1.limbs);
+    t0.assign_mul_add_1(m10, w00, m11, w10);
+    t1.assign_mul_add_1(m10, w01, m11, w11);
+    std::swap(m10.limbs, t0.limbs);
+    std::swap(m11.limbs, t1.limbs);
+    odd = odd != w_odd;
+  }
+
+  /**
+   * @brief Replaces (a, b) by M^-1 (a, b), if the steps of M are the first
+   * steps of Euclid's algorithm on (a, b).
+   * @return false, leaving a and b alone, if they are not.
+   *
+   * The quotients of M then form the start of the continued fraction of
+   * a / b, which is unique: that holds exactly when M^-1 (a, b) = (a', b')
+   * has a' > b' >= 0. M may thus come from the leading bits of a and b
+   * alone, and this checks whether it carries over.
+   */
+  bool apply(bigint &a, bigint &b) const {
+    bigint x = m11 * a - m01 * b;
+    bigint y = m00 * b - m10 * a;
+    if (odd) {
+      x.negate();
+      y.negate();
+    }
+    if (y.ne || x <= y)
+      return false;
+    a = std::move(x);
+    b = std::move(y);
+    return true;
+  }
+};
+
+/*
+ * The leading bits of a and b determine the first quotients of Euclid's
+ * algorithm on them. Each batch takes the top of a and b past bit s,
+ * reduces it halfway (recursively, or in machine words once small), and
+ * applies the cofactors to the full numbers, which costs a few
+ * multiplications instead of one pass per quotient. Truncating leaves the
+ * last quotients of a batch uncertain, so batches stop a limb short and
+ * gcd_matrix::apply verifies them; a plain division step moves on when one
+ * does not carry over, or when a quotient is too large for the top bits.
+ */
+inline void bigint::gcd_reduce(bigint &a, bigint &b, size_t stop,
+                               gcd_matrix *m) {
+  constexpr size_t margin = 64;
+  bigint x, y;
+  while (b.bit_length_abs() > stop) {
+    size_t n = a.bit_length_abs();
+    if (n <= 64) {
+      limb u = a.limbs[0], v = b.limbs[0];
+      if (!m) {
+        a = bigint(gcd_1(u, v));
+        b = bigint();
+        return;
+      }
+      // Euclid in words. The cofactors stay below the initial a.
+      limb m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+      bool odd = false;
+      while ((v >> stop) != 0) {
+        limb q = u / v;
+        u = std::exchange(v, u - q * v);
+        m01 = std::exchange(m00, q * m00 + m01);
+        m11 = std::exchange(m10, q * m10 + m11);
+        odd = !odd;
+      }
+      a = bigint(u);
+      b = bigint(v);
+      m->append_1(m00, m01, m10, m11, odd);
+      return;
+    }
+    if (n > 64 && n - b.bit_length_abs() < 32) {
+      // Aims a quarter of the way down, or at stop if that is closer, from
+      // the bits that determine the quotients up to there.
+      size_t t = std::max(stop, n - n / 4);
+      size_t s = 2 * t > n + margin ? 2 * t - n - margin : 0;
+      if (s != 0 && n - s >= 64 * hgcd_threshold) {
+        gcd_matrix batch;
+        bigint ah = a >> s, bh = b >> s;
+        gcd_reduce(ah, bh, t - s, &batch);
+        if (!batch.identity() && batch.apply(a, b)) {
+          if (m)
+            m->append(batch);
+          continue;
+        }
+      } else if (lehmer_step(a, b, stop, m, x, y)) {
+        continue;
+      }
+    }
+    bigint q, r;
+    divmod_abs(a, b, q, r);
+    q.normalize();
+    r.normalize();
+    if (m)
+      m->step(q);
+    a = std::exchange(b, std::move(r));
+  }
+}
+
+/*
+ * The quotients of the leading limb, stopped with 24 bits of headroom over
+ * the cofactors, which then fit in 32 bits. They are applied like
+ * gcd_matrix::apply, with the single-limb kernels into the buffers x and y.
+ */
+inline bool bigint::lehmer_step(bigint &a, bigint &b, size_t stop,
+                                gcd_matrix *m, bigint &x, bigint &y) {
+  size_t s = a.bit_length_abs() - 64;
+  limb ah = a.bits_at(s), bh = b.bits_at(s);
+  limb m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+  bool odd = false;
+  unsigned target =
+      static_cast<unsigned>(std::max<size_t>(40, stop > s ? stop - s : 0));
+  while (target < 64 && (bh >> target) != 0) {
+    limb q = ah / bh;
+    ah = std::exchange(bh, ah - q * bh);
+    m01 = std::exchange(m00, q * m00 + m01);
+    m11 = std::exchange(m10, q * m10 + m11);
+    odd = !odd;
+  }
+  size_t n = a.limbs.size();
+  if (m01 == 0 ||
+      !x.assign_mul_sub_1(odd ? b : a, odd ? m01 : m11, odd ? a : b,
+                          odd ? m11 : m01, n) ||
+      !y.assign_mul_sub_1(odd ? a : b, odd ? m10 : m00, odd ? b : a,
+                          odd ? m00 : m10, n) ||
+      x <= y)
+    return false;
+  std::swap(a.limbs, x.limbs);
+  std::swap(b.limbs, y.limbs);
+  if (m)
+    m->append_1(m00, m01, m10, m11, odd);
+  return true;
+}
+
+inline bigint gcd(const bigint &a, const bigint &b) {
+  bigint x = a, y = b;
+  x.ne = y.ne = false;
+  if (x < y)
+    std::swap(x, y);
+  bigint::gcd_reduce(x, y, 0, nullptr);
+  return x;
+}
+
+inline bigint lcm(const bigint &a, const bigint &b) {
+  if (a.limbs.empty() || b.limbs.empty())
+    return bigint();
+  bigint result = a / gcd(a, b) * b;
+  result.ne = false;
+  return result;
+}
+
+inline std::tuple<bigint, bigint, bigint> gcd_ext(const bigint &a,
+                                                  const bigint &b) {
+  bigint x = a, y = b;
+  x.ne = y.ne = false;
+  bool swapped = x < y;
+  if (swapped)
+    std::swap(x, y);
+  bigint::gcd_matrix m;
+  bigint::gcd_reduce(x, y, 0, &m);
+  // (|a|, |b|) = M (g, 0) up to the swap, so g = det (m11 |a| - m01 |b|).
+  bigint u = std::move(m.m11), v = -std::move(m.m01);
+  if (m.odd) {
+    u.negate();
+    v.negate();
+  }
+  if (swapped)
+    std::swap(u, v);
+  if (a.ne)
+    u.negate();
+  if (b.ne)
+    v.negate();
+  return {std::move(x), std::move(u), std::move(v)};
+}
+
+inline bigint inverse_mod(const bigint &a, const bigint &mod) {
+  if (mod.limbs.empty())
+    throw std::domain_error("Division by zero");
+  bigint m = mod;
+  m.ne = false;
+  bigint r = a % m;
+  if (r.ne)
+    r += m;
+  auto [g, x, y] = gcd_ext(r, m);
+  if (g != 1)
+    throw std::domain_error("Not invertible");
+  if (x.ne)
+    x += m;
+  return x;
+}
+
+/**
+ * @class fixed_bigint
+ * @brief Integer of a fixed Bits bits in two's complement, stored inline.
+ *
+ * Meant for hot loops on values known to fit, such as 256 or 512 bit
+ * arithmetic. Every operation runs over exactly Bits / 64 limbs in loops of
+ * constant trip count that the compiler unrolls, without heap use,
+ * normalization or size checks. Arithmetic wraps modulo 2^Bits like the
+ * unsigned native types, so overflow is well defined. All of it is
+ * constexpr except the conversions to bigint and strings.
+ */
+template <size_t Bits> class fixed_bigint {
+  static_assert(Bits > 0 && Bits % 64 == 0,
+                "fixed_bigint needs a positive multiple of 64 bits");
+  using limb = bigint::limb;
+  using dlimb = bigint::dlimb;
+
+public:
+  /**
+   * @brief Number of 64-bit limbs.
+   */
+  static constexpr size_t limb_count = Bits / 64;
+
+  /**
+   * @brief Default constructor, zero.
+   */
+  constexpr fixed_bigint() = default;
+
+  /**
+   * @brief Constructs from a native integer of up to 64 bits, sign
+   * extended.
+   * @param num The integer value to be used.
+   */
+  template <class T, bigint::if_integral<T> = 0>
+  constexpr fixed_bigint(T num) {
+    w[0] = static_cast<limb>(num);
+    limb fill = 0;
+    if constexpr (std::is_signed_v<T>)
+      fill = num < 0 ? ~limb(0) : 0;
+    for (size_t i = 1; i < limb_count; i++)
+      w[i] = fill;
+  }
+
+  /**
+   * @brief Converts a bigint, copying its limbs.
+   * @param num The bigint, in [-2^(Bits - 1), 2^(Bits - 1)).
+   * @throw std::out_of_range if num does not fit.
+   */
+  explicit fixed_bigint(const bigint &num) {
+    size_t n = num.limbs.size();
+    if (n > limb_count)
+      throw std::out_of_range("Value does not fit in fixed_bigint");
+    std::copy(num.limbs.begin(), num.limbs.end(), w);
+    if (negative()) {
+      // Only -2^(Bits - 1) has the top bit of its magnitude set.
+      bool min = num.ne && w[limb_count - 1] == limb(1) << 63;
+      for (size_t i = 0; min && i + 1 < limb_count; i++)
+        min = w[i] == 0;
+      if (!min)
+        throw std::out_of_range("Value does not fit in fixed_bigint");
+    }
+    if (num.ne)
+      *this = -*this;
+  }
+
+  /**
+   * @brief Converts to a bigint.
+   * @return The value, a single limb copy of the magnitude.
+   */
+  bigint to_bigint() const {
+    bool neg = negative();
+    fixed_bigint m = neg ? -*this : *this;
+    size_t n = limb_count;
+    while (n > 0 && m.w[n - 1] == 0)
+      n--;
+    bigint result;
+    result.limbs.assign(m.w, m.w + n);
+    result.ne = neg;
+    return result;
+  }
+
+  /**
+   * @brief Converts to a bigint, see to_bigint().
+   */
+  explicit operator bigint() const { return to_bigint(); }
+
+  /**
+   * @brief Converts to a decimal string.
+   */
+  std::string to_string() const { return to_bigint().to_string(); }
+
+  /**
+   * @brief Writes the decimal value to a stream.
+   * @param stream The stream to write to.
+   * @param num The value to write.
+   * @return The stream.
+   */
+  friend std::ostream &operator<<(std::ostream &stream,
+                                  const fixed_bigint &num) {
+    return stream << num.to_string();
+  }
+
+  /**
+   * @brief Whether the value is negative, its top bit.
+   */
+  constexpr bool negative() const { return w[limb_count - 1] >> 63; }
+
+  /**
+   * @brief The limbs, least significant first, in two's complement.
+   */
+  constexpr const limb *data() const { return w; }
+
+  /**
+   * @brief Addition assignment, modulo 2^Bits.
+   * @param rhs The value to add.
+   * @return Reference to *this.
+   */
+  constexpr fixed_bigint &operator+=(const fixed_bigint &rhs) {
+    limb c = 0;
+    BIGINT_UNROLL
+    for (size_t i = 0; i < limb_count; i++) {
+      dlimb t = static_cast<dlimb>(w[i]) + rhs.w[i] + c;
+      w[i] = static_cast<limb>(t);
+      c = static_cast<limb>(t >> 64);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Subtraction assignment, modulo 2^Bits.
+   * @param rhs The value to subtract.
+   * @return Reference to *this.
+   */
+  constexpr fixed_bigint &operator-=(const fixed_bigint &rhs) {
+    limb b = 0;
+    BIGINT_UNROLL
+    for (size_t i = 0; i < limb_count; i++) {
+      dlimb t = static_cast<dlimb>(w[i]) - rhs.w[i] - b;
+      w[i] = static_cast<limb>(t);
+      b = static_cast<limb>(t >> 64) & 1;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Multiplication assignment, modulo 2^Bits.
+   * @param rhs The value to multiply by.
+   * @return Reference to *this.
+   */
+  constexpr fixed_bigint &operator*=(const fixed_bigint &rhs) {
+    return *this = *this * rhs;
+  }
+
+  /**
+   * @brief Addition, modulo 2^Bits.
+   */
+  friend constexpr fixed_bigint operator+(fixed_bigint lhs,
+                                          const fixed_bigint &rhs) {
+    return lhs += rhs;
+  }
+
+  /**
+   * @brief Subtraction, modulo 2^Bits.
+   */
+  friend constexpr fixed_bigint operator-(fixed_bigint lhs,
+                                          const fixed_bigint &rhs) {
+    return lhs -= rhs;
+  }
+
+  /**
+   * @brief Multiplication, modulo 2^Bits.
+   *
+   * Schoolbook over the lower triangle of limb products, the only ones
+   * that reach the result; the same for signed and unsigned operands.
+   */
+  friend constexpr fixed_bigint operator*(const fixed_bigint &lhs,
+                                          const fixed_bigint &rhs) {
+    fixed_bigint r;
+    BIGINT_UNROLL
+    for (size_t i = 0; i < limb_count; i++) {
+      limb c = 0;
+      BIGINT_UNROLL
+      for (size_t j = 0; i + j < limb_count; j++) {
+        dlimb t = static_cast<dlimb>(lhs.w[i]) * rhs.w[j] + r.w[i + j] + c;
+        r.w[i + j] = static_cast<limb>(t);
+        c = static_cast<limb>(t >> 64);
+      }
+    }
+    return r;
+  }
+
+  /**
+   * @brief Negation, modulo 2^Bits.
+   */
+  constexpr fixed_bigint operator-() const { return fixed_bigint() - *this; }
+
+  /**
+   * @brief Bitwise NOT.
+   */
+  constexpr fixed_bigint operator~() const {
+    fixed_bigint r;
+    for (size_t i = 0; i < limb_count; i++)
+      r.w[i] = ~w[i];
+    return r;
+  }
+
+  /**
+   * @brief Left shift, modulo 2^Bits.
+   * @param bits The number of bits to shift by.
+   */
+  constexpr fixed_bigint operator<<(size_t bits) const {
+    fixed_bigint r;
+    if (bits >= Bits)
+      return r;
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    for (size_t i = limb_count; i-- > k;) {
+      r.w[i] = w[i - k] << s;
+      if (s != 0 && i > k)
+        r.w[i] |= w[i - k - 1] >> (64 - s);
+    }
+    return r;
+  }
+
+  /**
+   * @brief Arithmetic right shift, rounding toward negative infinity.
+   * @param bits The number of bits to shift by.
+   */
+  constexpr fixed_bigint operator>>(size_t bits) const {
+    limb fill = negative() ? ~limb(0) : 0;
+    fixed_bigint r;
+    for (size_t i = 0; i < limb_count; i++)
+      r.w[i] = fill;
+    if (bits >= Bits)
+      return r;
+    size_t k = bits / 64;
+    unsigned s = static_cast<unsigned>(bits % 64);
+    for (size_t i = 0; i + k < limb_count; i++) {
+      limb hi = i + k + 1 < limb_count ? w[i + k + 1] : fill;
+      r.w[i] = s == 0 ? w[i + k] : w[i + k] >> s | hi << (64 - s);
+    }
+    return r;
+  }
+
+  /**
+   * @brief Three-way comparison.
+   * @param rhs The value to compare with.
+   * @return Negative, zero or positive as *this is less than, equal to or
+   * greater than rhs.
+   */
+  constexpr int compare(const fixed_bigint &rhs) const {
+    if (negative() != rhs.negative())
+      return negative() ? -1 : 1;
+    BIGINT_UNROLL
+    for (size_t i = 0; i < limb_count; i++) {
+      size_t k = limb_count - 1 - i;
+      if (w[k] != rhs.w[k])
+        return w[k] < rhs.w[k] ? -1 : 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Comparison operators.
+   */
+  friend constexpr bool operator==(const fixed_bigint &lhs,
+                                   const fixed_bigint &rhs) {
+    return lhs.compare(rhs) == 0;
+  }
+  friend constexpr bool operator!=(const fixed_bigint &lhs,
+                                   const fixed_bigint &rhs) {
+    return lhs.compare(rhs) != 0;
+  }
+  friend constexpr bool operator<(const fixed_bigint &lhs,
+                                  const fixed_bigint &rhs) {
+    return lhs.compare(rhs) < 0;
+  }
+  friend constexpr bool operator<=(const fixed_bigint &lhs,
+                                   const fixed_bigint &rhs) {
+    return lhs.compare(rhs) <= 0;
+  }
+  friend constexpr bool operator>(const fixed_bigint &lhs,
+                                  const fixed_bigint &rhs) {
+    return lhs.compare(rhs) > 0;
+  }
+  friend constexpr bool operator>=(const fixed_bigint &lhs,
+                                   const fixed_bigint &rhs) {
+    return lhs.compare(rhs) >= 0;
+  }
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+  friend constexpr std::strong_ordering operator<=>(const fixed_bigint &lhs,
+                                                    const fixed_bigint &rhs) {
+    return lhs.compare(rhs) <=> 0;
+  }
+#endif
+
+private:
+  limb w[limb_count]{};
+};
+
+/**
+ * @class bigint_batch
+ * @brief Many independent bigints of one size class, stored as a structure
+ * of arrays for the elementwise batch_add, batch_sub, batch_mul and
+ * batch_compare.
+ *
+ * Each element has width() limbs in two's complement, width() being a size
+ * class: a power of two that fits every element. Limb j of element i is at
+ * data()[j * stride() + i], so the same limb of neighbouring elements is
+ * contiguous, and the stride pads the element count to whole blocks.
+ *
+ * The kernels take the elements a block at a time through each limb
+ * position, with the carries of the block kept per element, so that the
+ * compiler can run the block across SIMD lanes and no element branches on
+ * its value. Blocks are spread over bigint::mul_threads threads once the
+ * work reaches parallel_grain limb operations per thread.
+ */
+class bigint_batch {
+  using limb = bigint::limb;
+  using dlimb = bigint::dlimb;
+
+public:
+  /**
+   * @brief Elements per block, the stride being a multiple of it.
+   */
+  static constexpr size_t block = 8;
+
+  /**
+   * @brief Limb operations per thread from which the kernels use more than
+   * one thread.
+   */
+  static inline size_t parallel_grain = size_t(1) << 18;
+
+  /**
+   * @brief Default constructor, an empty batch.
+   */
+  bigint_batch() = default;
+
+  /**
+   * @brief A batch of zeros.
+   * @param count The number of elements.
+   * @param limbs The limbs each element must hold, rounded up to a size
+   * class.
+   */
+  bigint_batch(size_t count, size_t limbs)
+      : n(count), s((count + block - 1) / block * block),
+        w(size_class(limbs)), d(w * s) {}
+
+  /**
+   * @brief Converts a range of values.
+   * @param first The beginning of the range of values convertible to bigint.
+   * @param last The end of the range.
+   *
+   * The width is the size class of the largest element.
+   */
+  template <class It, std::enable_if_t<!std::is_integral_v<It>, int> = 0>
+  bigint_batch(It first, It last)
+      : bigint_batch(std::vector<bigint>(first, last)) {}
+
+  /**
+   * @brief Converts a vector of bigints, see the range constructor.
+   */
+  explicit bigint_batch(const std::vector<bigint> &values)
+      : bigint_batch(values.size(), max_limbs(values)) {
+    for (size_t i = 0; i < n; i++)
+      set(i, values[i]);
+  }
+
+  /**
+   * @brief Number of elements.
+   */
+  size_t size() const { return n; }
+
+  /**
+   * @brief Limbs of each element, a power of two.
+   */
+  size_t width() const { return w; }
+
+  /**
+   * @brief Distance between limb j and limb j + 1 of an element in data().
+   */
+  size_t stride() const { return s; }
+
+  /**
+   * @brief The limbs, see the class description.
+   */
+  const limb *data() const { return d.data(); }
+
+  /**
+   * @brief The size class of an element of the given limb count.
+   */
+  static size_t size_class(size_t limbs) {
+    size_t c = 1;
+    while (c < limbs)
+      c *= 2;
+    return c;
+  }
+
+  /**
+   * @brief Reads one element.
+   * @param i The index, below size().
+   */
+  bigint get(size_t i) const {
+    bool neg = d[(w - 1) * s + i] >> 63;
+    bigint result;
+    result.limbs.resize(w);
+    limb c = neg;
+    for (size_t j = 0; j < w; j++) {
+      limb x = d[j * s + i] ^ (neg ? ~limb(0) : 0);
+      result.limbs[j] = x + c;
+      c = result.limbs[j] < c;
+    }
+    result.ne = neg;
+    result.normalize();
+    return result;
+  }
+
+  /**
+   * @brief Writes one element.
+   * @param i The index, below size().
+   * @param value The value, which must fit in width() limbs.
+   * @throw std::out_of_range if it does not.
+   */
+  void set(size_t i, const bigint &value) {
+    if (limbs_of(value) > w)
+      throw std::out_of_range("Value does not fit in bigint_batch");
+    limb fill = value.ne ? ~limb(0) : 0;
+    limb c = value.ne;
+    for (size_t j = 0; j < w; j++) {
+      limb x = (j < value.limbs.size() ? value.limbs[j] : 0) ^ fill;
+      d[j * s + i] = x + c;
+      c = d[j * s + i] < c;
+    }
+  }
+
+  /**
+   * @brief Reads all elements.
+   */
+  std::vector<bigint> to_vector() const {
+    std::vector<bigint> result(n);
+    for (size_t i = 0; i < n; i++)
+      result[i] = get(i);
+    return result;
+  }
+
+  /**
+   * @brief Narrows to the smallest size class that still holds every
+   * element. Rows of limbs are dropped from the top, so nothing moves.
+   */
+  void shrink() {
+    while (w > 1) {
+      size_t h = w / 2;
+      limb differ = 0;
+      for (size_t j = h; j < w; j++)
+        for (size_t i = 0; i < s; i++)
+          differ |= d[j * s + i] ^ (0 - (d[(h - 1) * s + i] >> 63));
+      if (differ != 0)
+        break;
+      w = h;
+      d.resize(w * s);
+    }
+  }
+
+  /**
+   * @brief Elementwise sum.
+   * @throw std::invalid_argument if the batches differ in size.
+   *
+   * The result has the wider width of the two, or the next size class if
+   * some sum overflows it.
+   */
+  friend bigint_batch batch_add(const bigint_batch &a, const bigint_batch &b) {
+    return add_sub(a, b, false);
+  }
+
+  /**
+   * @brief Elementwise difference, see batch_add().
+   */
+  friend bigint_batch batch_sub(const bigint_batch &a, const bigint_batch &b) {
+    return add_sub(a, b, true);
+  }
+
+  /**
+   * @brief Elementwise product.
+   * @throw std::invalid_argument if the batches differ in size.
+   *
+   * Schoolbook on the magnitudes, with the signs applied afterwards without
+   * branches. The result is shrunk to the size class of its largest
+   * element.
+   */
+  friend bigint_batch batch_mul(const bigint_batch &a, const bigint_batch &b) {
+    return mul(a, b);
+  }
+
+  /**
+   * @brief Elementwise three-way comparison.
+   * @return For each element, negative, zero or positive as the element of
+   * a is less than, equal to or greater than that of b.
+   * @throw std::invalid_argument if the batches differ in size.
+   */
+  friend std::vector<int> batch_compare(const bigint_batch &a,
+                                        const bigint_batch &b) {
+    check_sizes(a, b);
+    size_t width = std::max(a.w, b.w);
+    std::vector<int> result(a.s);
+    for_blocks(a.s / block, a.s * width, [&](size_t first, size_t last) {
+      for (size_t k = first; k < last; k++) {
+        size_t i0 = k * block;
+        int r[block] = {};
+        limb fa[block], fb[block];
+        a.sign_fill(i0, fa);
+        b.sign_fill(i0, fb);
+        for (size_t j = width; j-- > 0;) {
+          const limb *x = a.row(j, i0, fa), *y = b.row(j, i0, fb);
+          // Signed order on the top limb, unsigned below.
+          limb flip = j == width - 1 ? limb(1) << 63 : 0;
+          for (size_t l = 0; l < block; l++) {
+            limb u = x[l] ^ flip, v = y[l] ^ flip;
+            int cmp = (u > v) - (u < v);
+            r[l] = r[l] != 0 ? r[l] : cmp;
+          }
+        }
+        std::copy(r, r + block, result.data() + i0);
+      }
+    });
+    result.resize(a.n);
+    return result;
+  }
+
+private:
+  size_t n = 0, s = 0, w = 1;
+  std::vector<limb> d;
+
+  /**
+   * @brief Limbs needed for value in two's complement.
+   */
+  static size_t limbs_of(const bigint &value) {
+    size_t bits = value.bit_length_abs();
+    // -2^k needs only k + 1 bits.
+    if (value.ne) {
+      const auto &m = value.limbs;
+      size_t top = m.size() - 1;
+      bool power = (m[top] & (m[top] - 1)) == 0 &&
+                   std::all_of(m.begin(), m.begin() + top,
+                               [](limb x) { return x == 0; });
+      bits -= power;
+    }
+    return bits / 64 + 1;
+  }
+
+  static size_t max_limbs(const std::vector<bigint> &values) {
+    size_t m = 1;
+    for (const bigint &v : values)
+      m = std::max(m, limbs_of(v));
+    return m;
+  }
+
+  static void check_sizes(const bigint_batch &a, const bigint_batch &b) {
+    if (a.n != b.n)
+      throw std::invalid_argument("Batch sizes differ");
+  }
+
+  /**
+   * @brief Calls f(first, last) on ranges of blocks that together cover
+   * [0, blocks), in parallel for a large amount of work.
+   */
+  template <class F>
+  static void for_blocks(size_t blocks, size_t work, const F &f) {
+    size_t tasks = std::min({bigint::mul_threads, blocks,
+                             std::max<size_t>(1, work / parallel_grain)});
+    if (tasks <= 1) {
+      f(0, blocks);
+      return;
+    }
+    bigint::parallel_for(tasks, bigint::parallel_threshold, [&](size_t t) {
+      f(blocks * t / tasks, blocks * (t + 1) / tasks);
+    });
+  }
+
+  /**
+   * @brief The sign extension limbs of block i0, all ones or zero.
+   */
+  void sign_fill(size_t i0, limb *fill) const {
+    for (size_t l = 0; l < block; l++)
+      fill[l] = 0 - (d[(w - 1) * s + i0 + l] >> 63);
+  }
+
+  /**
+   * @brief Limb j of block i0, read from fill past the width.
+   */
+  const limb *row(size_t j, size_t i0, const limb *fill) const {
+    return j < w ? d.data() + j * s + i0 : fill;
+  }
+
+  /**
+   * @brief Magnitudes of block i0 into m, limb j of lane l at
+   * m[j * block + l], and the sign masks into sign.
+   */
+  void magnitude(size_t i0, limb *m, limb *sign) const {
+    limb c[block];
+    sign_fill(i0, sign);
+    for (size_t l = 0; l < block; l++)
+      c[l] = sign[l] & 1;
+    for (size_t j = 0; j < w; j++)
+      for (size_t l = 0; l < block; l++) {
+        limb x = (d[j * s + i0 + l] ^ sign[l]) + c[l];
+        c[l] = x < c[l];
+        m[j * block + l] = x;
+      }
+  }
+
+  /**
+   * @brief Stores the magnitudes p of block i0, laid out as in magnitude(),
+   * negated where sign is all ones.
+   */
+  void store_negated(size_t i0, const limb *p, const limb *sign) {
+    limb c[block];
+    for (size_t l = 0; l < block; l++)
+      c[l] = sign[l] & 1;
+    for (size_t j = 0; j < w; j++)
+      for (size_t l = 0; l < block; l++) {
+        limb x = (p[j * block + l] ^ sign[l]) + c[l];
+        c[l] = x < c[l];
+        d[j * s + i0 + l] = x;
+      }
+  }
+
+  /**
+   * @brief a * b for batch_mul(). The magnitudes of a block are multiplied
+   * lane by lane with the limb kernels of bigint, as 64 x 64 -> 128-bit
+   * products have no SIMD form, then negated where the signs differ.
+   */
+  static bigint_batch mul(const bigint_batch &a, const bigint_batch &b) {
+    check_sizes(a, b);
+    size_t wa = a.w, wb = b.w;
+    bigint_batch r(a.n, wa + wb);
+    for_blocks(a.s / block, a.s * wa * wb, [&](size_t first, size_t last) {
+      std::vector<limb> buf((wa + wb + 2 * r.w) * block);
+      limb *ma = buf.data(), *mb = ma + wa * block, *p = mb + wb * block;
+      limb *x = p + r.w * block, *y = x + wa, *z = y + wb;
+      for (size_t k = first; k < last; k++) {
+        size_t i0 = k * block;
+        limb sa[block], sb[block];
+        a.magnitude(i0, ma, sa);
+        b.magnitude(i0, mb, sb);
+        for (size_t l = 0; l < block; l++) {
+          for (size_t i = 0; i < wa; i++)
+            x[i] = ma[i * block + l];
+          for (size_t j = 0; j < wb; j++)
+            y[j] = mb[j * block + l];
+          z[wb] = bigint::mul_1(z, y, wb, x[0]);
+          for (size_t i = 1; i < wa; i++)
+            z[i + wb] = bigint::addmul_1(z + i, y, wb, x[i]);
+          for (size_t j = 0; j < r.w; j++)
+            p[j * block + l] = j < wa + wb ? z[j] : 0;
+        }
+        for (size_t l = 0; l < block; l++)
+          sa[l] ^= sb[l];
+        r.store_negated(i0, p, sa);
+      }
+    });
+    r.shrink();
+    return r;
+  }
+
+  /**
+   * @brief a + b, or a - b if sub, at the wider width, then once more at
+   * the next size class if some element overflowed.
+   */
+  static bigint_batch add_sub(const bigint_batch &a, const bigint_batch &b,
+                              bool sub) {
+    check_sizes(a, b);
+    for (size_t width = std::max(a.w, b.w);; width *= 2) {
+      bigint_batch r(a.n, width);
+      std::atomic<bool> overflow{false};
+      for_blocks(a.s / block, a.s * width, [&](size_t first, size_t last) {
+        limb invert = sub ? ~limb(0) : 0, ovf = 0;
+        for (size_t k = first; k < last; k++) {
+          size_t i0 = k * block;
+          limb fa[block], fb[block], c[block];
+          a.sign_fill(i0, fa);
+          b.sign_fill(i0, fb);
+          std::fill(c, c + block, sub);
+          const limb *x = nullptr, *y = nullptr;
+          limb *out = nullptr;
+          for (size_t j = 0; j < width; j++) {
+            x = a.row(j, i0, fa);
+            y = b.row(j, i0, fb);
+            out = r.d.data() + j * r.s + i0;
+            for (size_t l = 0; l < block; l++) {
+              limb v = y[l] ^ invert;
+              limb t = x[l] + v;
+              limb sum = t + c[l];
+              c[l] = (t < x[l]) | (sum < t);
+              out[l] = sum;
+            }
+          }
+          // Signed overflow: equal operand signs, other result sign.
+          for (size_t l = 0; l < block; l++)
+            ovf |= ~(x[l] ^ y[l] ^ invert) & (x[l] ^ out[l]);
+        }
+        if (ovf >> 63)
+          overflow = true;
+      });
+      if (!overflow)
+        return r;
+    }
+  }
+};
+
+/**
+ * @brief Hash of a bigint, computed from its limbs and sign directly.
+ *
+ * Each limb is folded in with a multiply and xor-shift, and the result goes
+ * through the 64-bit MurmurHash3 finalizer. Equal values have the same
+ * normalized limbs, so they hash alike.
+ */
+namespace std {
+template <> struct hash<bigint> {
+  size_t operator()(const bigint &x) const noexcept {
+    uint64_t h = x.ne ? 0x9e3779b97f4a7c15ull : 0;
+    for (uint64_t l : x.limbs) {
+      h = (h ^ l) * 0xff51afd7ed558ccdull;
+      h ^= h >> 29;
     }
+    h ^= x.limbs.size();
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
   }
 };
+} // namespace std
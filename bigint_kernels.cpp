@@ -0,0 +1,187 @@
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Limb kernels compiled once per instruction set. bigint.hpp forwards to
+ * them instead of its inline loops when BIGINT_COMPILED_KERNELS is defined,
+ * which the bigint CMake target does when BIGINT_KERNELS is on.
+ *
+ * On x86-64 ELF targets each kernel has a portable version and one for
+ * BMI2 + ADX, and the exported symbol is a GNU indirect function: its
+ * resolver runs once when the program is loaded and binds the symbol to the
+ * version matching the CPU. A single binary thus runs everywhere at the
+ * speed of the best version, without a dispatch on every call. Elsewhere
+ * the symbols are the portable versions.
+ */
+
+#if defined(__x86_64__) && defined(__ELF__) &&                                 \
+    (defined(__GNUC__) || defined(__clang__))
+#define BIGINT_MULTIVERSION 1
+#else
+#define BIGINT_MULTIVERSION 0
+#endif
+
+typedef uint64_t limb;
+__extension__ typedef unsigned __int128 dlimb;
+
+extern "C" {
+
+/**
+ * @brief r += a * b over n limbs, for a single limb b.
+ * @return The limb carried out of r[n - 1].
+ */
+static limb addmul_1_portable(limb *r, const limb *a, size_t n, limb b) {
+  limb c = 0;
+  for (size_t i = 0; i < n; i++) {
+    dlimb t = static_cast<dlimb>(a[i]) * b + r[i] + c;
+    r[i] = static_cast<limb>(t);
+    c = static_cast<limb>(t >> 64);
+  }
+  return c;
+}
+
+/**
+ * @brief r = a * b over n limbs, for a single limb b.
+ * @return The limb carried out of r[n - 1].
+ */
+static limb mul_1_portable(limb *r, const limb *a, size_t n, limb b) {
+  limb c = 0;
+  for (size_t i = 0; i < n; i++) {
+    dlimb t = static_cast<dlimb>(a[i]) * b + c;
+    r[i] = static_cast<limb>(t);
+    c = static_cast<limb>(t >> 64);
+  }
+  return c;
+}
+
+#if BIGINT_MULTIVERSION
+/*
+ * The BMI2 + ADX versions run blocks of four limbs through mulx, which
+ * leaves the flags alone, and keep two independent carry chains: adcx (CF)
+ * adds the high half of the previous product and adox (OF) adds the limb
+ * of r. The loop counter lives in rcx so that lea and jrcxz can close the
+ * loop without touching either flag. The remaining limbs go through the
+ * portable loop, starting from the combined carry.
+ */
+
+static limb addmul_1_adx(limb *r, const limb *a, size_t n, limb b) {
+  limb c = 0;
+  if (size_t blocks = n / 4) {
+    limb lo, h0, h1;
+    __asm__("xorl %k[lo], %k[lo]\n\t" // Clears CF and OF.
+            "1:\n\t"
+            "mulxq (%[a]), %[lo], %[h0]\n\t"
+            "adcxq %[c], %[lo]\n\t"
+            "adoxq (%[r]), %[lo]\n\t"
+            "movq %[lo], (%[r])\n\t"
+            "mulxq 8(%[a]), %[lo], %[h1]\n\t"
+            "adcxq %[h0], %[lo]\n\t"
+            "adoxq 8(%[r]), %[lo]\n\t"
+            "movq %[lo], 8(%[r])\n\t"
+            "mulxq 16(%[a]), %[lo], %[h0]\n\t"
+            "adcxq %[h1], %[lo]\n\t"
+            "adoxq 16(%[r]), %[lo]\n\t"
+            "movq %[lo], 16(%[r])\n\t"
+            "mulxq 24(%[a]), %[lo], %[c]\n\t"
+            "adcxq %[h0], %[lo]\n\t"
+            "adoxq 24(%[r]), %[lo]\n\t"
+            "movq %[lo], 24(%[r])\n\t"
+            "leaq 32(%[a]), %[a]\n\t"
+            "leaq 32(%[r]), %[r]\n\t"
+            "leaq -1(%[n]), %[n]\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n\t"
+            "2:\n\t"
+            // The top limb of the result fits, so neither add overflows.
+            "movl $0, %k[lo]\n\t"
+            "adcxq %[lo], %[c]\n\t"
+            "adoxq %[lo], %[c]"
+            : [lo] "=&r"(lo), [h0] "=&r"(h0), [h1] "=&r"(h1), [c] "+&r"(c),
+              [a] "+&r"(a), [r] "+&r"(r), [n] "+&c"(blocks)
+            : "d"(b)
+            : "cc", "memory");
+  }
+  for (size_t i = 0; i < n % 4; i++) {
+    dlimb t = static_cast<dlimb>(a[i]) * b + r[i] + c;
+    r[i] = static_cast<limb>(t);
+    c = static_cast<limb>(t >> 64);
+  }
+  return c;
+}
+
+static limb mul_1_adx(limb *r, const limb *a, size_t n, limb b) {
+  limb c = 0;
+  if (size_t blocks = n / 4) {
+    limb lo, h0, h1;
+    // Only the CF chain is needed. r may equal a, every limb of a is read
+    // before the limb of r at the same index is written.
+    __asm__("xorl %k[lo], %k[lo]\n\t"
+            "1:\n\t"
+            "mulxq (%[a]), %[lo], %[h0]\n\t"
+            "adcxq %[c], %[lo]\n\t"
+            "movq %[lo], (%[r])\n\t"
+            "mulxq 8(%[a]), %[lo], %[h1]\n\t"
+            "adcxq %[h0], %[lo]\n\t"
+            "movq %[lo], 8(%[r])\n\t"
+            "mulxq 16(%[a]), %[lo], %[h0]\n\t"
+            "adcxq %[h1], %[lo]\n\t"
+            "movq %[lo], 16(%[r])\n\t"
+            "mulxq 24(%[a]), %[lo], %[c]\n\t"
+            "adcxq %[h0], %[lo]\n\t"
+            "movq %[lo], 24(%[r])\n\t"
+            "leaq 32(%[a]), %[a]\n\t"
+            "leaq 32(%[r]), %[r]\n\t"
+            "leaq -1(%[n]), %[n]\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n\t"
+            "2:\n\t"
+            "movl $0, %k[lo]\n\t"
+            "adcxq %[lo], %[c]"
+            : [lo] "=&r"(lo), [h0] "=&r"(h0), [h1] "=&r"(h1), [c] "+&r"(c),
+              [a] "+&r"(a), [r] "+&r"(r), [n] "+&c"(blocks)
+            : "d"(b)
+            : "cc", "memory");
+  }
+  for (size_t i = 0; i < n % 4; i++) {
+    dlimb t = static_cast<dlimb>(a[i]) * b + c;
+    r[i] = static_cast<limb>(t);
+    c = static_cast<limb>(t >> 64);
+  }
+  return c;
+}
+
+// Resolvers run before the sanitizer runtimes are set up, so they must not
+// be instrumented.
+#define BIGINT_RESOLVER __attribute__((no_sanitize_address))
+
+BIGINT_RESOLVER static bool has_adx() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+}
+
+typedef limb (*kernel)(limb *, const limb *, size_t, limb);
+
+BIGINT_RESOLVER static kernel resolve_addmul_1() {
+  return has_adx() ? addmul_1_adx : addmul_1_portable;
+}
+
+BIGINT_RESOLVER static kernel resolve_mul_1() {
+  return has_adx() ? mul_1_adx : mul_1_portable;
+}
+
+uint64_t bigint_addmul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+    __attribute__((ifunc("resolve_addmul_1")));
+uint64_t bigint_mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+    __attribute__((ifunc("resolve_mul_1")));
+#else
+uint64_t bigint_addmul_1(uint64_t *r, const uint64_t *a, size_t n,
+                         uint64_t b) {
+  return addmul_1_portable(r, a, n, b);
+}
+
+uint64_t bigint_mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+  return mul_1_portable(r, a, n, b);
+}
+#endif
+
+} // extern "C"
@@ -1,8 +1,36 @@
 #include "bigint.hpp"
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Counts the bytes handed out, on top of the default resource.
+struct counting_resource : std::pmr::memory_resource {
+  size_t live = 0;
+  size_t allocations = 0;
+  void *do_allocate(size_t bytes, size_t align) override {
+    live += bytes;
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void *p, size_t bytes, size_t align) override {
+    live -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+    return this == &other;
+  }
+};
 
 int main() {
   size_t total = 0;
@@ -21,6 +49,14 @@ int main() {
     }
   };
 
+  // n decimal digits following the pattern (i * mul + add) % 10.
+  auto digits = [](size_t n, size_t mul, size_t add) {
+    std::string s;
+    for (size_t i = 0; i < n; i++)
+      s += static_cast<char>('0' + (i * mul + add) % 10);
+    return s;
+  };
+
   test("Default constructor", [&]() {
     bigint a;
     if (a != bigint(0))
@@ -33,6 +69,38 @@ int main() {
       throw std::runtime_error("int64_t constructor failed.");
   });
 
+  test("Native integer constructors and to_int64", [&]() {
+    const int64_t min = -9223372036854775807LL - 1;
+    const int64_t max = 9223372036854775807LL;
+    if (bigint(min).to_string() != "-9223372036854775808" ||
+        bigint(max).to_string() != "9223372036854775807" ||
+        bigint(18446744073709551615ULL).to_string() !=
+            "18446744073709551615" ||
+        bigint(static_cast<unsigned char>(200)) != bigint(200) ||
+        bigint(short(-5)) != bigint(-5) || bigint(0u).to_string() != "0")
+      throw std::runtime_error("Native integer constructor failed.");
+    __extension__ typedef unsigned __int128 u128;
+    u128 wide = (static_cast<u128>(0x0123456789abcdefULL) << 64) | 5u;
+    if (bigint(wide).to_string() != "1512366075204170928967596825190072325" ||
+        bigint(static_cast<u128>(7)) != bigint(7) ||
+        bigint(static_cast<u128>(0)).to_string() != "0")
+      throw std::runtime_error("unsigned __int128 constructor failed.");
+    if (bigint(min).to_int64() != min || bigint(max).to_int64() != max ||
+        bigint(0).to_int64() != 0 || bigint("-42").to_int64() != -42)
+      throw std::runtime_error("to_int64 failed.");
+    for (const char *s : {"9223372036854775808", "-9223372036854775809",
+                          "18446744073709551616"}) {
+      bool e = false;
+      try {
+        bigint(s).to_int64();
+      } catch (const std::out_of_range &) {
+        e = true;
+      }
+      if (bigint(s).fits_int64() || !e)
+        throw std::runtime_error(std::string("to_int64 accepted ") + s);
+    }
+  });
+
   test("String constructor", [&]() {
     bigint a(1111);
     std::ostringstream oss;
@@ -60,6 +128,28 @@ int main() {
       throw std::runtime_error("Didn't throw exception upon invalid input.");
   });
 
+  test("String constructor with invalid input past the first word", [&]() {
+    for (const char *s : {"12345678901234567890x", "1234567890123456-", "-",
+                          "123456789\x80""1234567", "12 34"}) {
+      bool e = false;
+      try {
+        bigint a(s);
+      } catch (const std::invalid_argument &) {
+        e = true;
+      }
+      if (!e)
+        throw std::runtime_error(std::string("Accepted ") + s);
+    }
+  });
+
+  test("Buffer and string_view constructors", [&]() {
+    const char buf[] = "-12345678901234567890123xyz";
+    std::string_view view(buf + 1, 23);
+    if (bigint(buf, 24) != bigint("-12345678901234567890123") ||
+        bigint(view) != bigint(std::string("12345678901234567890123")))
+      throw std::runtime_error("Buffer constructors failed.");
+  });
+
   test("+", [&]() {
     bigint a(1111);
     bigint b(1);
@@ -76,6 +166,14 @@ int main() {
       throw std::runtime_error("+ with negative numbers failed.");
   });
 
+  test("+ with mixed signs", [&]() {
+    bigint a(-5);
+    bigint b(3);
+    if (a + b != bigint(-2) || b + a != bigint(-2) || bigint(5) + bigint(-3) !=
+        bigint(2))
+      throw std::runtime_error("+ with mixed signs failed.");
+  });
+
   test("-", [&]() {
     bigint a("1000000000000000000");
     bigint b(1);
@@ -108,6 +206,114 @@ int main() {
       throw std::runtime_error("negative * failed.");
   });
 
+  test("+ across limb boundary", [&]() {
+    bigint a("18446744073709551615");
+    bigint c = a + bigint(1);
+    if (c != bigint("18446744073709551616"))
+      throw std::runtime_error("+ across limb boundary failed.");
+  });
+
+  test("- across limb boundary", [&]() {
+    bigint a("340282366920938463463374607431768211456");
+    bigint c = a - bigint(1);
+    if (c != bigint("340282366920938463463374607431768211455"))
+      throw std::runtime_error("- across limb boundary failed.");
+  });
+
+  test("* multi-limb", [&]() {
+    bigint a("123456789012345678901234567890");
+    bigint b("-987654321098765432109876543210");
+    bigint c = a * b;
+    if (c != bigint("-1219326311370217952261850327336229233322374638011112"
+                    "63526900"))
+      throw std::runtime_error("* multi-limb failed.");
+  });
+
+  test("String round trip", [&]() {
+    std::string s = "-1000000000000000000000000000000000000000000000000000000"
+                    "00000000000000000000000000000000000000000000000000000001";
+    std::ostringstream oss;
+    oss << bigint(s);
+    if (oss.str() != s)
+      throw std::runtime_error("String round trip failed.");
+  });
+
+  test("String constructor with leading zeros", [&]() {
+    if (bigint("-0000") != bigint(0) || bigint("000123") != bigint(123))
+      throw std::runtime_error("Leading zeros not normalized.");
+  });
+
+  test("* Karatsuba and Toom-3", [&]() {
+    // (10^k - 1)^2 = 99..9800..01, large enough to cross both cutoffs.
+    size_t k = 20000;
+    bigint a(std::string(k, '9'));
+    std::string expected = std::string(k - 1, '9') + "8" +
+                           std::string(k - 1, '0') + "1";
+    if (a * a != bigint(expected))
+      throw std::runtime_error("Karatsuba/Toom-3 * failed.");
+  });
+
+  test("* cutoffs agree with schoolbook", [&]() {
+    std::string x = digits(5000, 7, 3), y = digits(5000, 13, 5);
+    bigint a(x), b("-" + y.substr(0, 3000));
+    size_t karatsuba = bigint::karatsuba_threshold;
+    size_t toom3 = bigint::toom3_threshold;
+    bigint fast = a * b;
+    bigint::karatsuba_threshold = bigint::toom3_threshold = SIZE_MAX;
+    bigint slow = a * b;
+    bigint::karatsuba_threshold = karatsuba;
+    bigint::toom3_threshold = toom3;
+    if (fast != slow)
+      throw std::runtime_error("Fast * disagrees with schoolbook.");
+  });
+
+  test("* NTT", [&]() {
+    size_t k = 250000;
+    bigint a(std::string(k, '9'));
+    std::string expected = std::string(k - 1, '9') + "8" +
+                           std::string(k - 1, '0') + "1";
+    if (a * a != bigint(expected))
+      throw std::runtime_error("NTT square failed.");
+  });
+
+  test("* NTT agrees with Toom-3", [&]() {
+    std::string x = digits(4000, 7, 3), y = digits(4000, 13, 5);
+    bigint a(x), b(y);
+    bigint slow_product = a * b, slow_square = a * a;
+    size_t ntt = bigint::ntt_threshold;
+    bigint::ntt_threshold = 8;
+    bigint fast_product = a * b, fast_square = a * a;
+    bigint::ntt_threshold = ntt;
+    if (fast_product != slow_product || fast_square != slow_square)
+      throw std::runtime_error("NTT * disagrees with Toom-3.");
+  });
+
+  test("* parallel agrees with serial", [&]() {
+    std::string x = digits(20000, 7, 3), y = digits(20000, 13, 5);
+    bigint a(x), b(y.substr(0, 15000));
+    bigint product = a * b, square = a.square();
+    size_t ntt = bigint::ntt_threshold;
+    bigint::ntt_threshold = 512;
+    bigint ntt_product = a * b;
+    bigint::ntt_threshold = ntt;
+
+    size_t parallel = bigint::parallel_threshold;
+    bigint::mul_threads = 4;
+    bigint::parallel_threshold = 16;
+    bool same = a * b == product && a.square() == square;
+    // An executor that runs each task right away on the submitting thread.
+    bigint::mul_executor = [](std::function<void()> task) { task(); };
+    same = same && a * b == product;
+    bigint::mul_executor = nullptr;
+    bigint::ntt_threshold = 512;
+    same = same && a * b == ntt_product;
+    bigint::ntt_threshold = ntt;
+    bigint::mul_threads = 1;
+    bigint::parallel_threshold = parallel;
+    if (!same || ntt_product != product)
+      throw std::runtime_error("Parallel * disagrees with serial.");
+  });
+
   test("+=", [&]() {
     bigint a(999999);
     a += bigint(1);
@@ -129,6 +335,207 @@ int main() {
       throw std::runtime_error("*= failed.");
   });
 
+  test("+= and -= in place", [&]() {
+    bigint a(5);
+    (a += bigint(10)) -= bigint(20);
+    if (a != bigint(-5))
+      throw std::runtime_error("Chained +=/-= failed.");
+    a -= a;
+    if (a != bigint(0))
+      throw std::runtime_error("a -= a failed.");
+    bigint b("18446744073709551615");
+    b += b;
+    if (b != bigint("36893488147419103230"))
+      throw std::runtime_error("a += a failed.");
+    b -= bigint("36893488147419103231");
+    if (b != bigint(-1))
+      throw std::runtime_error("-= crossing zero failed.");
+  });
+
+  test("*= in place", [&]() {
+    bigint a("-18446744073709551616");
+    a *= bigint(3);
+    if (a != bigint("-55340232221128654848"))
+      throw std::runtime_error("*= by one limb failed.");
+    a *= a;
+    if (a != bigint("3062541302288446171170371466885913903104"))
+      throw std::runtime_error("a *= a failed.");
+    a *= bigint(0);
+    if (a != bigint(0))
+      throw std::runtime_error("*= 0 failed.");
+  });
+
+  test("/ and % truncate toward zero", [&]() {
+    if (bigint(7) / bigint(2) != bigint(3) || bigint(-7) / bigint(2) !=
+        bigint(-3) || bigint(7) / bigint(-2) != bigint(-3))
+      throw std::runtime_error("/ failed.");
+    if (bigint(7) % bigint(2) != bigint(1) || bigint(-7) % bigint(2) !=
+        bigint(-1) || bigint(7) % bigint(-2) != bigint(1))
+      throw std::runtime_error("% failed.");
+  });
+
+  test("/ multi-limb", [&]() {
+    bigint a("-121932631137021795226185032733622923332237463801111263526900");
+    bigint b("987654321098765432109876543210");
+    if (a / b != bigint("-123456789012345678901234567890") ||
+        a % b != bigint(0))
+      throw std::runtime_error("/ multi-limb failed.");
+    bigint c = a - bigint(5);
+    if (c / b != bigint("-123456789012345678901234567890") ||
+        c % b != bigint(-5))
+      throw std::runtime_error("% multi-limb failed.");
+  });
+
+  test("/ by zero", [&]() {
+    bool e = false;
+    try {
+      bigint(1) / bigint(0);
+    } catch (const std::domain_error &) {
+      e = true;
+    }
+    if (!e)
+      throw std::runtime_error("Didn't throw upon division by zero.");
+  });
+
+  test("divmod Burnikel-Ziegler", [&]() {
+    std::string x = digits(20000, 7, 3), y = digits(6000, 13, 5);
+    bigint a(x), b("-" + y);
+    auto [q, r] = a.divmod(b);
+    if (q * b + r != a || r < bigint(0) || r >= -b)
+      throw std::runtime_error("divmod identity failed.");
+    size_t bz = bigint::burnikel_ziegler_threshold;
+    bigint::burnikel_ziegler_threshold = SIZE_MAX;
+    auto [q2, r2] = a.divmod(b);
+    bigint::burnikel_ziegler_threshold = bz;
+    if (q != q2 || r != r2)
+      throw std::runtime_error("Burnikel-Ziegler disagrees with Knuth.");
+  });
+
+  test("/= and %=", [&]() {
+    bigint a(1000001);
+    a /= bigint(10);
+    if (a != bigint(100000))
+      throw std::runtime_error("/= failed.");
+    a %= bigint(7);
+    if (a != bigint(5))
+      throw std::runtime_error("%= failed.");
+  });
+
+  test("square", [&]() {
+    for (size_t n : {5, 40, 1000, 8000, 60000}) {
+      std::string x = digits(n, 7, 3);
+      bigint a("-" + x);
+      bigint b = a; // A different object, so a * b is a general product
+      if (a.square() != a * b || a * a != a * b)
+        throw std::runtime_error("square disagrees with *.");
+    }
+  });
+
+  test("pow", [&]() {
+    if (pow(bigint(2), 100) != bigint("1267650600228229401496703205376") ||
+        pow(bigint(-3), 5) != bigint(-243) || pow(bigint(-3), 4) !=
+        bigint(81) || pow(bigint(0), 0) != bigint(1) || pow(bigint(0), 3) !=
+        bigint(0))
+      throw std::runtime_error("pow failed.");
+    bigint big("123456789012345678901234567890");
+    if (pow(big, 7) != big * big * big * big * big * big * big)
+      throw std::runtime_error("pow of multi-limb base failed.");
+    if (pow(bigint(1), 100000000000) != 1 ||
+        pow(bigint(-1), uint64_t(1) << 62) != 1 ||
+        pow(bigint(-1), (uint64_t(1) << 62) + 1) != -1)
+      throw std::runtime_error("pow of a unit failed.");
+    // 64 bits times 2^58 does not fit in size_t.
+    try {
+      pow(bigint(UINT64_MAX), uint64_t(1) << 58);
+      throw std::runtime_error("pow did not reject an oversized result.");
+    } catch (const std::length_error &) {
+    }
+  });
+
+  test("pow_mod", [&]() {
+    if (pow_mod(bigint(4), bigint(13), bigint(497)) != bigint(445) ||
+        pow_mod(bigint(-4), bigint(13), bigint(497)) != bigint(52) ||
+        pow_mod(bigint(7), bigint(0), bigint(1)) != bigint(0))
+      throw std::runtime_error("pow_mod failed.");
+    // Fermat: a^(p-1) = 1 mod p for the prime 2^127 - 1.
+    bigint p = pow(bigint(2), 127) - bigint(1);
+    if (pow_mod(bigint("123456789123456789"), p - bigint(1), p) != bigint(1))
+      throw std::runtime_error("pow_mod Fermat check failed.");
+  });
+
+  test("product, sum, factorial and binomial", [&]() {
+    std::vector<int64_t> v;
+    bigint folded_product = 1, folded_sum;
+    for (int64_t i = 1; i <= 500; i++) {
+      v.push_back(i % 7 == 0 ? -i * 1000003 : i * 1000003);
+      folded_product *= bigint(v.back());
+      folded_sum += bigint(v.back());
+    }
+    if (bigint::product(v.begin(), v.end()) != folded_product ||
+        bigint::sum(v.begin(), v.end()) != folded_sum ||
+        bigint::product(v.begin(), v.begin()) != bigint(1) ||
+        bigint::sum(v.begin(), v.begin()) != bigint(0))
+      throw std::runtime_error("product or sum failed.");
+
+    bigint f = 1;
+    for (uint64_t n = 0; n <= 300; n++) {
+      if (n > 0)
+        f *= bigint(static_cast<int64_t>(n));
+      if (bigint::factorial(n) != f)
+        throw std::runtime_error("factorial(" + std::to_string(n) +
+                                 ") failed.");
+    }
+    // 300! / (120! * 180!), through the prime factorization.
+    bigint c = bigint::factorial(300) /
+               (bigint::factorial(120) * bigint::factorial(180));
+    if (bigint::binomial(300, 120) != c || bigint::binomial(300, 180) != c ||
+        bigint::binomial(5, 6) != bigint(0) ||
+        bigint::binomial(1000000, 2) != bigint(499999500000) ||
+        bigint::binomial(7, 0) != bigint(1))
+      throw std::runtime_error("binomial failed.");
+  });
+
+  test("montgomery_context", [&]() {
+    bigint p = pow(bigint(2), 127) - bigint(1);
+    bigint::montgomery_context ctx(p);
+    bigint a("98765432109876543210987654321");
+    bigint b("-1234567890123456789012345678901234567890");
+    bigint am = ctx.to_montgomery(a);
+    bigint bm = ctx.to_montgomery(b);
+    bigint r = b % p + p;
+    if (ctx.from_montgomery(am) != a ||
+        ctx.from_montgomery(ctx.mul_mod(am, bm)) != a * r % p ||
+        ctx.from_montgomery(ctx.sqr_mod(bm)) != r * r % p)
+      throw std::runtime_error("Montgomery arithmetic failed.");
+    if (ctx.pow_mod(a, p - bigint(1)) != bigint(1) ||
+        ctx.pow_mod(bigint(3), bigint(1000)) !=
+            pow(bigint(3), 1000) % p ||
+        ctx.pow_mod(a, bigint(0)) != bigint(1))
+      throw std::runtime_error("Montgomery pow_mod failed.");
+    bool thrown = false;
+    try {
+      bigint::montgomery_context even(bigint(1000));
+    } catch (const std::invalid_argument &) {
+      thrown = true;
+    }
+    if (!thrown)
+      throw std::runtime_error("Even Montgomery modulus was accepted.");
+  });
+
+  test("barrett_context", [&]() {
+    // An even modulus, and a power of 2^64 where the reciprocal is largest.
+    for (bigint m : {pow(bigint(10), 60), pow(bigint(2), 128)}) {
+      bigint::barrett_context ctx(m);
+      bigint a = pow(bigint(7), 80) + bigint(5);
+      bigint b = -pow(bigint(3), 90);
+      bigint r = b % m + m;
+      if (ctx.mul_mod(a, b) != a % m * r % m ||
+          ctx.sqr_mod(a) != a * a % m ||
+          ctx.pow_mod(a, bigint(321)) != pow(a, 321) % m)
+        throw std::runtime_error("Barrett arithmetic failed.");
+    }
+  });
+
   test("negation", [&]() {
     bigint a(123);
     bigint b = -a;
@@ -186,6 +593,18 @@ int main() {
       throw std::runtime_error("<< failed.");
   });
 
+  test("to_string", [&]() {
+    if (bigint(0).to_string() != "0" || bigint(-42).to_string() != "-42")
+      throw std::runtime_error("to_string of small values failed.");
+    // Long enough to recurse, with runs of zeros across the split points.
+    for (size_t k : {607, 608, 1216, 5000}) {
+      std::string s = "-1" + std::string(k, '0') + "1" + std::string(k, '0');
+      std::string nines(k * 2, '9');
+      if (bigint(s).to_string() != s || bigint(nines).to_string() != nines)
+        throw std::runtime_error("to_string of large values failed.");
+    }
+  });
+
   test("Pre-increment ++", [&]() {
     bigint a(999);
     ++a;
@@ -214,7 +633,602 @@ int main() {
       throw std::runtime_error("Post-decrement failed.");
   });
 
+  test("++ and -- across zero and limbs", [&]() {
+    bigint a(-1);
+    ++a;
+    if (a != bigint(0))
+      throw std::runtime_error("++ from -1 failed.");
+    --a;
+    --a;
+    if (a != bigint(-2))
+      throw std::runtime_error("-- below zero failed.");
+    bigint b("18446744073709551615");
+    ++b;
+    if (b != bigint("18446744073709551616"))
+      throw std::runtime_error("++ across limbs failed.");
+    --b;
+    if (b != bigint("18446744073709551615"))
+      throw std::runtime_error("-- across limbs failed.");
+    bigint c("-18446744073709551616");
+    ++c;
+    if (c != bigint("-18446744073709551615"))
+      throw std::runtime_error("++ of negative across limbs failed.");
+  });
+
+  test("Copy and move between inline and heap storage", [&]() {
+    bigint small(42);
+    bigint large("1234567890123456789012345678901234567890123456789");
+    std::vector<bigint> v{small, large, small};
+    v.push_back(std::move(v[1]));
+    v[1] = v[3];
+    v[0] = large;
+    v[3] = small;
+    v[2] = v[2];
+    if (v[0] != large || v[1] != large || v[2] != small || v[3] != small)
+      throw std::runtime_error("Copy or move lost the value.");
+    bigint moved = std::move(v[1]);
+    v[1] = std::move(v[2]);
+    if (moved != large || v[1] != small)
+      throw std::runtime_error("Move lost the value.");
+  });
+
+  test("addmul and submul", [&]() {
+    bigint a("123456789012345678901234567890");
+    bigint b("-98765432109876543210");
+    bigint c("5555555555555555555555555555555555555555555555555");
+    bigint r = c;
+    r.addmul(a, b).submul(b, b);
+    bigint big = pow(bigint(3), 4000); // Past the Karatsuba cutoff.
+    bigint s = -c;
+    s.addmul(big, big);
+    bigint t = a;
+    t.submul(t, t); // Aliasing the accumulator.
+    if (r != c + a * b - b * b || s != big * big - c || t != a - a * a)
+      throw std::runtime_error("Fused multiply-add failed.");
+    bigint z;
+    z.submul(a, b);
+    if (z != -(a * b))
+      throw std::runtime_error("Fused multiply-add into zero failed.");
+  });
+
+  test("Shifts", [&]() {
+    bigint a("123456789012345678901234567890");
+    bigint b = a;
+    b <<= 130;
+    if ((a << 130) != a * pow(bigint(2), 130) || b != (a << 130) ||
+        (b >> 130) != a || (a >> 200) != bigint(0) || (a << 0) != a)
+      throw std::runtime_error("Shift of a positive number failed.");
+    // Negative numbers round toward negative infinity.
+    b = -a;
+    b >>= 3;
+    if ((-a >> 3) != (-a - bigint(7)) / bigint(8) || b != (-a >> 3) ||
+        (bigint(-1) >> 100) != bigint(-1) || (bigint(-16) >> 4) != bigint(-1))
+      throw std::runtime_error("Shift of a negative number failed.");
+  });
+
+  test("Bitwise operators in two's complement", [&]() {
+    bigint x("340282366920938463463374607431768211455"); // 2^128 - 1
+    bigint y(-6);
+    if ((x & y) != x - bigint(5) || (x | y) != bigint(-1) ||
+        (x ^ y) != bigint(4) - x ||
+        ~x != -x - bigint(1) || ~y != bigint(5) || ~bigint(0) != bigint(-1))
+      throw std::runtime_error("Bitwise operators failed.");
+    if ((bigint(-12) & bigint(-10)) != bigint(-12) ||
+        (bigint(-12) | bigint(-10)) != bigint(-10) ||
+        (bigint(-12) ^ bigint(-10)) != bigint(2))
+      throw std::runtime_error("Bitwise operators on negatives failed.");
+    bigint z = x;
+    z ^= z;
+    if (z != bigint(0))
+      throw std::runtime_error("x ^= x is not zero.");
+  });
+
+  test("bit_length, popcount and test_bit", [&]() {
+    bigint x = pow(bigint(2), 100) + bigint(5);
+    if (x.bit_length() != 101 || x.popcount() != 3 || bigint(0).bit_length() ||
+        !x.test_bit(100) || !x.test_bit(2) || x.test_bit(1) ||
+        x.test_bit(1000))
+      throw std::runtime_error("Bit queries failed.");
+    // -12 is ...110100 in two's complement.
+    bigint y(-12);
+    if (y.test_bit(0) || y.test_bit(1) || !y.test_bit(2) || y.test_bit(3) ||
+        !y.test_bit(4) || !y.test_bit(500))
+      throw std::runtime_error("test_bit on a negative number failed.");
+  });
+
+  test("compare", [&]() {
+    bigint big("123456789012345678901234567890");
+    bigint values[] = {-big, bigint(-5), bigint(0), bigint(5), big};
+    for (int i = 0; i < 5; i++) {
+      for (int j = 0; j < 5; j++) {
+        int c = values[i].compare(values[j]);
+        if ((c < 0) != (i < j) || (c == 0) != (i == j) ||
+            (values[i] < values[j]) != (i < j) ||
+            (values[i] <= values[j]) != (i <= j) ||
+            (values[i] > values[j]) != (i > j) ||
+            (values[i] >= values[j]) != (i >= j))
+          throw std::runtime_error("compare disagrees with the order.");
+      }
+    }
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+    if ((values[0] <=> values[4]) != std::strong_ordering::less ||
+        (big <=> values[4]) != std::strong_ordering::equal)
+      throw std::runtime_error("operator<=> failed.");
+#endif
+  });
+
+  test("std::hash", [&]() {
+    std::hash<bigint> h;
+    bigint a("98765432109876543210987654321");
+    bigint b = a * bigint(3) - a - a; // Same value, built differently.
+    if (h(a) != h(b) || h(bigint(0)) != h(bigint("-0")) || h(a) == h(-a))
+      throw std::runtime_error("Equal values hash differently.");
+    std::unordered_map<bigint, int> map;
+    for (int i = 0; i < 1000; i++)
+      map[pow(bigint(3), static_cast<uint64_t>(i))] = i;
+    if (map.size() != 1000 || map.at(pow(bigint(3), 777)) != 777)
+      throw std::runtime_error("unordered_map lookup failed.");
+  });
+
+  test("Mixed operations with native integers", [&]() {
+    bigint a("-123456789012345678901234567890");
+    const uint64_t big = 18446744073709551615ULL;
+    const int64_t small = -9223372036854775807LL - 1;
+    int64_t signed_values[] = {0, 1, -1, 7, -7, small, 9223372036854775807LL};
+    for (int64_t v : signed_values) {
+      bigint b(v);
+      if (a + v != a + b || v + a != b + a || a - v != a - b ||
+          v - a != b - a || a * v != a * b || v * a != b * a)
+        throw std::runtime_error("Mixed +, - or * failed.");
+      if (v != 0 && (a / v != a / b || a % v != a % b))
+        throw std::runtime_error("Mixed / or % failed.");
+      if ((a < v) != (a < b) || (v < a) != (b < a) || (a == v) != (a == b) ||
+          (bigint(v) != v) || (v != bigint(v)) || !(b <= v) || !(v >= b))
+        throw std::runtime_error("Mixed comparison failed.");
+    }
+    bigint m("18446744073709551615");
+    if (bigint(1) + big != m + bigint(1) || bigint(0) - big != -m ||
+        a * big != a * m || a / big != a / m || a % big != a % m ||
+        big / a != bigint(0) || m != big || !(m > small) || m == -1)
+      throw std::runtime_error("Mixed uint64_t operations failed.");
+    bigint c = -m;
+    c += big; // Crosses zero: result must normalize to 0.
+    if (c != 0 || c.to_string() != "0")
+      throw std::runtime_error("Mixed += did not normalize.");
+    c = bigint(5);
+    c -= 7u;
+    c *= -3;
+    c /= short(2);
+    c %= 2;
+    if (c != 1)
+      throw std::runtime_error("Mixed compound assignment failed.");
+    bool threw = false;
+    try {
+      a /= 0;
+    } catch (const std::domain_error &) {
+      threw = true;
+    }
+    if (!threw)
+      throw std::runtime_error("Division by integer zero did not throw.");
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    __cpp_impl_three_way_comparison >= 201907L
+    if ((a <=> 0) != std::strong_ordering::less ||
+        (0 <=> a) != std::strong_ordering::greater)
+      throw std::runtime_error("Mixed operator<=> failed.");
+#endif
+  });
+
+  test("Memory resource binding", [&]() {
+    counting_resource counter;
+
+    bigint a = pow(bigint(3), 5000);
+    bigint b = pow(bigint(7), 3000);
+    bigint expected = a * b + a - b;
+    bigint kept;
+    {
+      bigint::scoped_memory_resource scope(&counter);
+      if (bigint::get_memory_resource() != &counter)
+        throw std::runtime_error("Resource was not bound.");
+      bigint r = a * b + a - b;
+      bigint::set_memory_resource(nullptr);
+      kept = r; // A copy made outside the resource.
+      bigint::set_memory_resource(&counter);
+      if (counter.allocations == 0 || r != expected)
+        throw std::runtime_error("Temporaries did not use the resource.");
+    }
+    if (counter.live != 0 || kept != expected ||
+        bigint::get_memory_resource() != std::pmr::new_delete_resource())
+      throw std::runtime_error("Resource was not released or restored.");
+
+    // A bump arena released in one go after the batch.
+    std::pmr::monotonic_buffer_resource arena;
+    bigint sum;
+    {
+      bigint::scoped_memory_resource scope(&arena);
+      bigint acc;
+      for (int i = 0; i < 100; i++)
+        acc += a * bigint(i);
+      bigint::set_memory_resource(nullptr);
+      sum = acc;
+      bigint::set_memory_resource(&arena);
+    }
+    arena.release();
+    if (sum != a * bigint(4950))
+      throw std::runtime_error("Arena batch gave the wrong result.");
+  });
+
+  test("Rvalue operators reuse the expiring operand", [&]() {
+    bigint a = pow(bigint(3), 5000);
+    bigint b = pow(bigint(7), 3000);
+    bigint c = pow(bigint(11), 100);
+    if ((a + b) - c != a + b - c || a - (b + c) != a - b - c ||
+        (a - b) * c != a * c - b * c || -(a - b) != b - a ||
+        ((a ^ b) & (a | c)) != ((a ^ b) & (a | c)) ||
+        (bigint(a) << 70) >> 70 != a || ~(-a) != a - 1 ||
+        5 - (a + 1) != 4 - a || (a + 0) * 3 != a * 3 ||
+        (a + b) / 7 != (a + b) / bigint(7) || -(a - a) != 0 ||
+        std::move(bigint(a)) + std::move(bigint(b)) != a + b)
+      throw std::runtime_error("Rvalue operators gave the wrong result.");
+    bigint x = a, y = b;
+    if (std::move(x) - x != 0 || x != 0 || y - std::move(y) != 0)
+      throw std::runtime_error("Aliased rvalue operands failed.");
+
+    counting_resource counter;
+    bigint::scoped_memory_resource scope(&counter);
+    // |b| > |a| and b << 3 still fits in the limbs of b, so every result
+    // fits in the storage of the operand it takes over.
+    bigint t1 = b, t2 = b;
+    size_t before = counter.allocations;
+    bigint r1 = -std::move(t1);
+    bigint r2 = std::move(r1) + a;
+    bigint r3 = a - std::move(t2);
+    bigint r4 = std::move(r2) << 3;
+    if (counter.allocations != before)
+      throw std::runtime_error("Rvalue operators allocated.");
+    if (r3 != a - b || r4 != (a - b) * 8)
+      throw std::runtime_error("Rvalue chain gave the wrong result.");
+  });
+
+  test("Statistics counters", [&]() {
+    bigint a = pow(bigint(3), 100000); // About 2500 limbs
+    bigint b = a + 1;
+    bigint::reset_stats();
+    bigint c = a * b;
+    bigint q = c / a;
+    std::string s = bigint(12345).to_string();
+    bigint::statistics st = bigint::stats();
+    if (!bigint::stats_enabled) {
+      if (st.mul.calls != 0 || st.allocations != 0)
+        throw std::runtime_error("Counters moved without BIGINT_STATS.");
+      return;
+    }
+    if (q != b || st.div.calls != 1 || st.print.calls != 1 ||
+        st.mul.limbs < a.bit_length() / 32 || st.mul_toom3.calls == 0 ||
+        st.mul_schoolbook.calls == 0 || st.div_burnikel_ziegler.calls == 0 ||
+        st.div_knuth.calls == 0 || st.allocations == 0 ||
+        st.scratch_allocations == 0 || st.mul.nanoseconds == 0)
+      throw std::runtime_error("Unexpected counters.");
+    bigint::reset_stats();
+    st = bigint::stats();
+    if (st.mul.calls != 0 || st.allocations != 0 || st.scratch_bytes != 0)
+      throw std::runtime_error("reset_stats did not clear the counters.");
+  });
+
+  test("Integer square and k-th roots", [&]() {
+    if (isqrt(bigint(0)) != 0 || isqrt(bigint(15)) != 3 ||
+        isqrt(bigint(16)) != 4 || iroot(bigint(-27), 3) != -3 ||
+        iroot(bigint(-26), 3) != -2 || iroot(bigint(7), 1) != 7 ||
+        iroot(bigint(1), 100) != 1)
+      throw std::runtime_error("Wrong root of a small value.");
+    bigint r = pow(bigint(3), 5000) + 12345;
+    bigint n = r.square() + 2 * r; // (r + 1)^2 - 1
+    if (isqrt(n) != r || isqrt(n + 1) != r + 1)
+      throw std::runtime_error("Wrong square root.");
+    for (uint64_t k : {3, 5, 16}) {
+      n = pow(r, k);
+      if (iroot(n, k) != r || iroot(n - 1, k) != r - 1)
+        throw std::runtime_error("Wrong k-th root.");
+    }
+    for (auto f : {+[] { isqrt(bigint(-1)); }, +[] { iroot(bigint(-4), 2); },
+                   +[] { iroot(bigint(4), 0); }}) {
+      bool e = false;
+      try {
+        f();
+      } catch (const std::domain_error &) {
+        e = true;
+      }
+      if (!e)
+        throw std::runtime_error("Accepted an invalid root.");
+    }
+  });
+
+  test("gcd, lcm, extended gcd and modular inverse", [&]() {
+    if (gcd(bigint(0), bigint(0)) != 0 || gcd(bigint(-12), bigint(18)) != 6 ||
+        gcd(bigint(0), bigint(-5)) != 5 || lcm(bigint(-4), bigint(6)) != 12 ||
+        lcm(bigint(0), bigint(6)) != 0)
+      throw std::runtime_error("Wrong gcd or lcm of small values.");
+    bigint p = pow(bigint(2), 4423) - 1; // A Mersenne prime
+    bigint q = bigint::factorial(3000) + 1;
+    bigint g = pow(bigint(7), 900);
+    size_t saved = bigint::hgcd_threshold;
+    for (size_t threshold : {saved, size_t(4)}) {
+      bigint::hgcd_threshold = threshold;
+      bigint a = p * g, b = -q * g;
+      if (gcd(a, b) != g || gcd(b, a) != g || lcm(a, b) != p * q * g)
+        throw std::runtime_error("Wrong gcd.");
+      auto [d, x, y] = gcd_ext(a, b);
+      if (d != g || a * x + b * y != g || x.bit_length() > q.bit_length() ||
+          y.bit_length() > p.bit_length())
+        throw std::runtime_error("Wrong extended gcd.");
+      bigint inv = inverse_mod(q, p);
+      if (inv < 0 || inv >= p || q * inv % p != 1 ||
+          inv != pow_mod(q, p - 2, p))
+        throw std::runtime_error("Wrong modular inverse.");
+    }
+    bigint::hgcd_threshold = saved;
+    bool e = false;
+    try {
+      inverse_mod(g, g * 2);
+    } catch (const std::domain_error &) {
+      e = true;
+    }
+    if (!e)
+      throw std::runtime_error("Inverted a value sharing a factor.");
+  });
+
+  test("fixed_bigint", [&]() {
+    using i256 = fixed_bigint<256>;
+    static_assert(i256(3) * 5 - 1 == 14 && -i256(7) < 2);
+    static_assert((i256(1) << 255).negative() && (i256(-8) >> 1) == -4);
+    static_assert(i256(uint64_t(-1)) + 1 == i256(1) << 64);
+    constexpr i256 p = [] {
+      i256 x = 1;
+      for (int i = 0; i < 150; i++)
+        x *= 3;
+      return x;
+    }();
+    if (p.to_bigint() != pow(bigint(3), 150) ||
+        (bigint(p * p) - pow(bigint(3), 300)) % (bigint(1) << 256) != 0)
+      throw std::runtime_error("Wrong constexpr product.");
+
+    // Against bigint arithmetic reduced to 512 bits in two's complement.
+    using i512 = fixed_bigint<512>;
+    bigint mod = bigint(1) << 512;
+    auto wrap = [&](bigint x) {
+      x = x % mod;
+      if (x < 0)
+        x += mod;
+      return x >= mod / 2 ? x - mod : x;
+    };
+    bigint a = -pow(bigint(7), 180), b = pow(bigint(5), 200) + 1;
+    i512 fa(a), fb(b);
+    if (bigint(fa + fb) != wrap(a + b) || bigint(fa - fb) != wrap(a - b) ||
+        bigint(fa * fb) != wrap(a * b) || bigint(fb << 100) != wrap(b << 100) ||
+        bigint(fa >> 77) != (a >> 77) || bigint(-fa) != -a ||
+        bigint(~fb) != ~b || fa.compare(fb) >= 0 || !(fa < fb) ||
+        fa != i512(a) || i512(bigint(fa.to_string())) != fa)
+      throw std::runtime_error("fixed_bigint disagrees with bigint.");
+    for (const bigint &v : {mod / 2, -mod / 2 - 1, mod})
+      try {
+        i512 x(v);
+        throw std::runtime_error("Accepted a value that does not fit.");
+      } catch (const std::out_of_range &) {
+      }
+    if (bigint(i512(-mod / 2)) != -mod / 2)
+      throw std::runtime_error("Wrong minimum value.");
+  });
+
+  test("Binary serialization and bigint_view", [&]() {
+    std::vector<bigint> values = {bigint(0), bigint(-1), bigint(1) << 64,
+                                  -pow(bigint(7), 500),
+                                  pow(bigint(3), 20000)};
+    for (const bigint &v : values) {
+      std::vector<std::byte> bytes = v.to_bytes();
+      if (bytes.size() != v.byte_size() || bigint::from_bytes(
+              bytes.data(), bytes.size()) != v)
+        throw std::runtime_error("to_bytes round trip failed.");
+    }
+    std::vector<std::byte> bytes = bigint(-2).to_bytes();
+    if (bytes.size() != 16 || bytes[0] != std::byte{3} ||
+        bytes[8] != std::byte{2})
+      throw std::runtime_error("Unexpected record layout.");
+
+    // Records written back to back, read from a stream and viewed in place.
+    std::ostringstream out;
+    for (const bigint &v : values)
+      v.write(out);
+    std::string file = out.str();
+    std::istringstream in(file);
+    for (const bigint &v : values)
+      if (bigint::read(in) != v)
+        throw std::runtime_error("Stream round trip failed.");
+    std::vector<uint64_t> mapped(file.size() / 8);
+    std::memcpy(mapped.data(), file.data(), file.size());
+    size_t offset = 0;
+    for (const bigint &v : values) {
+      const char *at = reinterpret_cast<const char *>(mapped.data()) + offset;
+      bigint_view view(at, file.size() - offset);
+      if (view != v || view.compare(v + 1) >= 0 ||
+          bigint(view) != v || view.to_string() != v.to_string())
+        throw std::runtime_error("bigint_view disagrees with the value.");
+      bigint sum = values[3];
+      sum += view;
+      sum -= view;
+      if (sum != values[3])
+        throw std::runtime_error("Arithmetic with a view failed.");
+      offset += view.record_size();
+    }
+    if (offset != file.size())
+      throw std::runtime_error("Records have the wrong size.");
+
+    auto rejects = [](auto f) {
+      try {
+        f();
+      } catch (const std::invalid_argument &) {
+        return true;
+      }
+      return false;
+    };
+    std::vector<std::byte> big = values[4].to_bytes();
+    std::vector<std::byte> neg_zero(8, std::byte{0});
+    neg_zero[0] = std::byte{1};
+    std::vector<std::byte> leading = bigint(5).to_bytes();
+    leading[0] = std::byte{4};
+    leading.resize(24);
+    std::istringstream cut(file.substr(0, file.size() - 1));
+    for (int i = 0; i < static_cast<int>(values.size()) - 1; i++)
+      bigint::read(cut);
+    if (!rejects([&] { bigint::from_bytes(big.data(), big.size() - 8); }) ||
+        !rejects([&] { bigint::from_bytes(big.data(), 7); }) ||
+        !rejects([&] { bigint::from_bytes(neg_zero.data(), 8); }) ||
+        !rejects([&] { bigint::from_bytes(leading.data(), 24); }) ||
+        !rejects([&] { bigint::read(cut); }) ||
+        !rejects([&] {
+          bigint_view(reinterpret_cast<const char *>(mapped.data()) + 4, 64);
+        }))
+      throw std::runtime_error("Accepted a malformed record.");
+  });
+
+  test("Batched operations", [&]() {
+    std::vector<bigint> xs, ys;
+    for (int i = 0; i < 61; i++) {
+      bigint x = pow(bigint(3), 2 * i) - 1, y = pow(bigint(7), i);
+      bigint edge = (bigint(1) << (64 * (i % 4 + 1) - 1)) - 1;
+      xs.push_back(i % 3 == 0 ? -x : i % 5 == 0 ? edge : x);
+      ys.push_back(i % 2 == 0 ? -y : i % 7 == 0 ? -edge - 1 : y);
+    }
+    bigint_batch a(xs), b(ys.begin(), ys.end());
+    if (a.width() != 4 || a.size() != 61 || a.stride() % bigint_batch::block ||
+        a.to_vector() != xs || b.get(7) != ys[7])
+      throw std::runtime_error("Wrong batch layout.");
+    auto check = [&]() {
+      bigint_batch sum = batch_add(a, b), diff = batch_sub(a, b);
+      bigint_batch product = batch_mul(a, b);
+      std::vector<int> order = batch_compare(a, b);
+      for (size_t i = 0; i < xs.size(); i++)
+        if (sum.get(i) != xs[i] + ys[i] || diff.get(i) != xs[i] - ys[i] ||
+            product.get(i) != xs[i] * ys[i] ||
+            (order[i] > 0) - (order[i] < 0) != xs[i].compare(ys[i]))
+          throw std::runtime_error("Batch disagrees with bigint.");
+    };
+    check();
+    size_t grain = bigint_batch::parallel_grain;
+    size_t parallel = bigint::parallel_threshold;
+    bigint_batch::parallel_grain = 1;
+    bigint::parallel_threshold = 1;
+    bigint::mul_threads = 3;
+    check();
+    bigint::mul_threads = 1;
+    bigint::parallel_threshold = parallel;
+    bigint_batch::parallel_grain = grain;
+
+    bigint_batch small(3, 1);
+    small.set(0, bigint(1) << 62);
+    small.set(1, -(bigint(1) << 63));
+    bigint_batch doubled = batch_add(small, small);
+    if (doubled.width() != 2 || doubled.get(0) != bigint(1) << 63 ||
+        doubled.get(1) != -(bigint(1) << 64) || doubled.get(2) != 0 ||
+        batch_mul(small, bigint_batch(3, 1)).width() != 1)
+      throw std::runtime_error("Wrong batch size class.");
+    try {
+      small.set(2, bigint(1) << 63);
+      throw std::runtime_error("Accepted a value that does not fit.");
+    } catch (const std::out_of_range &) {
+    }
+    try {
+      batch_add(small, a);
+      throw std::runtime_error("Added batches of different sizes.");
+    } catch (const std::invalid_argument &) {
+    }
+  });
+
+  test("Shared cache of conversion powers", [&]() {
+    // Powers of a base used nowhere else are computed inside an arena, and
+    // the next one from them after the arena is gone.
+    {
+      std::pmr::monotonic_buffer_resource arena;
+      bigint::scoped_memory_resource scope(&arena);
+      bigint::warm_powers(20000, 23);
+    }
+    bigint::warm_powers(40000, 23);
+
+    std::string text(200000, '7');
+    text[0] = '1';
+    bigint::warm_powers(text.size());
+    std::vector<std::string> out(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < out.size(); t++)
+      threads.emplace_back([&, t] {
+        std::string d = text.substr(0, 50000 * (t + 1) - 1);
+        for (int i = 0; i < 3; i++)
+          out[t] = bigint(d).to_string() == d ? "ok" : d;
+      });
+    for (std::thread &thread : threads)
+      thread.join();
+    for (const std::string &o : out)
+      if (o != "ok")
+        throw std::runtime_error("Wrong concurrent round trip.");
+    for (unsigned base : {0u, 1u, 37u})
+      try {
+        bigint::warm_powers(100, base);
+        throw std::runtime_error("Accepted an invalid base.");
+      } catch (const std::invalid_argument &) {
+      }
+  });
+
+  test("Radix conversion", [&]() {
+    bigint big = pow(bigint(2), 4000) - pow(bigint(3), 5000);
+    if (bigint(255).to_string(16) != "ff" ||
+        bigint(-5).to_string(2) != "-101" || bigint(0).to_string(36) != "0" ||
+        bigint::from_string("-Zz", 36) != -1295 ||
+        bigint::from_string("00017", 8) != 15 ||
+        (bigint(1) << 200).to_string(32) != "1" + std::string(40, '0') ||
+        pow(bigint(7), 900).to_string(7) != "1" + std::string(900, '0'))
+      throw std::runtime_error("Wrong digits.");
+    for (unsigned base = 2; base <= 36; base++) {
+      std::string out = big.to_string(base);
+      bigint slow = 0;
+      for (char c : out.substr(1))
+        slow = slow * base + (c <= '9' ? c - '0' : c - 'a' + 10);
+      if (out[0] != '-' || -slow != big ||
+          bigint::from_string(out, base) != big)
+        throw std::runtime_error("Wrong round trip in base " +
+                                 std::to_string(base) + ".");
+    }
+
+    char buf[8];
+    bigint x;
+    std::to_chars_result w = bigint(-255).to_chars(buf, buf + 3, 16);
+    std::from_chars_result r = bigint::from_chars(buf, buf + 8, x, 16);
+    if (w.ec != std::errc() || w.ptr != buf + 3 ||
+        bigint(-256).to_chars(buf, buf + 3, 16).ec !=
+            std::errc::value_too_large ||
+        std::string(buf, w.ptr) != "-ff" || r.ec != std::errc() ||
+        r.ptr != buf + 3 || x != -255)
+      throw std::runtime_error("Wrong to_chars or from_chars.");
+    std::string text = "-1g";
+    if (bigint::from_chars(text.data(), text.data() + 3, x, 16).ptr !=
+            text.data() + 2 ||
+        x != -1 ||
+        bigint::from_chars(text.data(), text.data() + 1, x).ec !=
+            std::errc::invalid_argument)
+      throw std::runtime_error("Wrong partial parse.");
+    for (std::string bad : {"", "-", "12", "1 "})
+      try {
+        bigint::from_string(bad, 2);
+        throw std::runtime_error("Parsed an invalid string.");
+      } catch (const std::invalid_argument &) {
+      }
+    try {
+      big.to_string(37);
+      throw std::runtime_error("Accepted an invalid base.");
+    } catch (const std::invalid_argument &) {
+    }
+  });
+
   std::cout << "Total: " << total << "\n";
   std::cout << "Passed: " << passed << "\n";
   std::cout << "Failed: " << (total - passed) << "\n";
+  return passed == total ? 0 : 1;
 }